@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 /* HTTP query string parser */
 
@@ -17,21 +18,73 @@ struct query_arg
 {
 	char *key;
 	char *value;
+
+	/* Whether value has already been percent-decoded in place, set by
+	 * query_args_parse(). Must be false in caller-built arrays.
+	 */
+	bool decoded;
 };
 
 /**
  * @brief Parse a query string and store the key-value pairs in the args array
  * 
  * Leading question mark "?" is optional, but arguments will only be
- * parsed after the last question mark found in the string.
+ * parsed after the last question mark found in the string. The key ends at
+ * the first '=', later ones belong to the value ("a=b=c" gives "a" and
+ * "b=c"), as with all query parsers and streams.
  * 
  * @param url 
  * @param qargs 
  * @param alen 
- * @return int 
+ * @return int Number of arguments found, if greater than alen, extra
+ *  arguments have been dropped
  */
 int query_args_parse(char *url, struct query_arg qargs[], size_t alen);
 
+/**
+ * @brief Count arguments query_args_parse() would find, without parsing
+ *
+ * @param url Query string, left untouched
+ * @return int Number of arguments, negative value on error
+ */
+int query_args_count(const char *url);
+
+/**
+ * @brief Caller-provided storage for query arguments, which can grow
+ */
+struct query_arena
+{
+	struct query_arg *qargs;
+	size_t alen;
+
+	/**
+	 * @brief Grow qargs to at least count elements, updating qargs and alen
+	 *
+	 * Optional, return 0 on success.
+	 */
+	int (*grow)(struct query_arena *arena, size_t count);
+
+	void *user_data;
+};
+
+/**
+ * @brief Parse a query string into an arena, sized by a counting pre-scan
+ *
+ * If the arena is too small, it is grown to the exact number of arguments
+ * before parsing, so no argument is dropped.
+ *
+ * @return int Number of arguments, -ENOMEM if the arena could not grow
+ */
+int query_args_parse_arena(char *url, struct query_arena *arena);
+
+/**
+ * @brief Get the value of the first argument matching key
+ *
+ * The value is percent-decoded in place on first access, so keys never
+ * read are never decoded and a value is never decoded twice.
+ *
+ * @return char* Decoded value, NULL if not found or without value
+ */
 char *query_arg_get(struct query_arg qargs[], size_t alen, const char *key);
 
 static inline bool query_arg_is_set(const char *key, struct query_arg qargs[], size_t alen)
@@ -39,16 +92,290 @@ static inline bool query_arg_is_set(const char *key, struct query_arg qargs[], s
 	return query_arg_get(qargs, alen, key) != NULL;
 }
 
+/**
+ * @brief Iterate over all arguments matching key (e.g. "?id=1&id=2&id=3")
+ *
+ * @param qargs Parsed arguments
+ * @param alen Number of arguments
+ * @param key Key to match
+ * @param cursor Iteration state, must be initialized to 0
+ * @return struct query_arg* Next matching argument, value decoded as with
+ *  query_arg_get(), NULL when done
+ */
+struct query_arg *query_arg_next(struct query_arg qargs[],
+				 size_t alen,
+				 const char *key,
+				 size_t *cursor);
+
+/**
+ * @brief Decode percent-escapes ("%2F") and '+' (as space) of a query value
+ *
+ * Runs without escapes are copied at once. Invalid escape sequences are
+ * kept as is. Decoding in place (dst == src) is supported.
+ *
+ * @param src Value to decode
+ * @param len Length of the value
+ * @param dst Output buffer, NUL-terminated on success
+ * @param size Size of the output buffer
+ * @return int Length of the decoded value, -ENOMEM if dst is too small
+ */
+int query_value_decode(const char *src, size_t len, char *dst, size_t size);
+
 /**
  * @brief Parse a query string, but only return the value for the given key
  * 
+ * Single pass: keys are compared while being tokenized and parsing stops
+ * at the first matching key. Only the bytes already scanned are modified,
+ * the number of arguments in the query string is not limited.
+ * 
  * @param url 
  * @param key 
- * @return char* 
+ * @return char* Value of the first argument matching key, percent-decoded
+ *  in place, NULL if not found or if the argument has no value
  */
 char *query_args_parse_find(char *url, const char *key);
 
 
+/* Hashed index over parsed query arguments */
+
+struct query_index
+{
+	struct query_arg *qargs;
+	uint32_t *slots;
+	size_t mask;
+	uint32_t seed;
+};
+
+/**
+ * @brief Build an open-addressed hash index over parsed query arguments
+ *
+ * The index lives in caller-provided storage and references qargs, which
+ * must outlive it. Keys longer than CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_KEY_LEN
+ * are not indexed. The seed should be random (e.g. per request or per boot)
+ * so that colliding keys cannot be crafted in advance.
+ *
+ * @param idx Index to build
+ * @param qargs Parsed arguments
+ * @param count Number of arguments (return value of query_args_parse())
+ * @param slots Storage for the index, at least twice count is recommended
+ * @param slots_count Number of slots, must be a power of two greater than count
+ * @param seed Hash seed
+ * @return int Number of indexed keys, -E2BIG if count exceeds
+ *  CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_ARGS, other negative value on error
+ */
+int query_index_build(struct query_index *idx,
+		      struct query_arg qargs[],
+		      size_t count,
+		      uint32_t slots[],
+		      size_t slots_count,
+		      uint32_t seed);
+
+/**
+ * @brief Find first argument matching key in the index
+ *
+ * @return struct query_arg* Argument, value decoded as with query_arg_get(),
+ *  NULL if not found
+ */
+struct query_arg *query_index_find(const struct query_index *idx, const char *key);
+
+static inline char *query_index_get(const struct query_index *idx, const char *key)
+{
+	struct query_arg *const arg = query_index_find(idx, key);
+
+	return arg ? arg->value : NULL;
+}
+
+
+/* Non-destructive query string parser */
+
+struct query_span
+{
+	size_t offset;
+	size_t len;
+};
+
+/**
+ * @brief Key and value of a query argument, as offsets in the parsed buffer
+ *
+ * A value can never start at offset 0 (it always follows a '='), so
+ * value.offset == 0 means that the argument has no value.
+ */
+struct query_arg_span
+{
+	struct query_span key;
+	struct query_span value;
+};
+
+static inline bool query_arg_span_has_value(const struct query_arg_span *arg)
+{
+	return arg->value.offset != 0u;
+}
+
+/**
+ * @brief Same as query_args_parse(), but the buffer is left untouched and
+ * arguments are returned as spans (offsets relative to url).
+ *
+ * @param url Query string, not necessarily NUL-terminated
+ * @param len Length of the query string
+ * @param spans Array to fill
+ * @param alen Size of the array
+ * @return int Number of arguments found, negative value on error
+ */
+int query_args_parse_spans(const char *url,
+			   size_t len,
+			   struct query_arg_span spans[],
+			   size_t alen);
+
+const struct query_arg_span *query_arg_span_get(const char *url,
+						const struct query_arg_span spans[],
+						size_t alen,
+						const char *key);
+
+/**
+ * @brief Iterate over all arguments matching key in an unparsed query string
+ *
+ * The query string is left untouched and no storage is needed besides the
+ * cursor. Arguments are only looked for after the last '?'.
+ *
+ * @param url Query string
+ * @param len Length of the query string
+ * @param key Key to match
+ * @param cursor Iteration state, must be initialized to 0
+ * @param arg Next matching argument
+ * @return int 0 if an argument was found, -ENOENT when done
+ */
+int query_args_parse_next(const char *url,
+			  size_t len,
+			  const char *key,
+			  size_t *cursor,
+			  struct query_arg_span *arg);
+
+/**
+ * @brief Decode the value of a span argument into buf
+ *
+ * @return int Length of the decoded value, negative value on error
+ */
+int query_arg_span_decode(const char *url,
+			  const struct query_arg_span *arg,
+			  char *buf,
+			  size_t size);
+
+/**
+ * @brief NUL-terminate a span in place, the delimiter following the span
+ * is overwritten. Only for mutable buffers.
+ *
+ * A span ending at the end of the URL needs a spare byte after it,
+ * size is the size of the whole url buffer.
+ *
+ * @return char* Pointer to the NUL-terminated span, NULL if the
+ * terminator does not fit in the buffer
+ */
+static inline char *query_span_terminate(char *url,
+					 size_t size,
+					 const struct query_span *span)
+{
+	if (span->offset + span->len >= size) {
+		return NULL;
+	}
+
+	url[span->offset + span->len] = '\0';
+	return &url[span->offset];
+}
+
+/**
+ * @brief Copy a span to buf and NUL-terminate it.
+ *
+ * @return char* buf on success, NULL if buf is too small
+ */
+char *query_span_copy(const char *url,
+		      const struct query_span *span,
+		      char *buf,
+		      size_t size);
+
+
+/* Schema-driven typed query string parser */
+
+struct query_schema_key
+{
+	const char *name;
+	uint8_t len;
+
+	/* ROUTE_ARG_UINT, ROUTE_ARG_HEX or ROUTE_ARG_STR */
+	uint8_t type;
+};
+
+/**
+ * @brief Expected query keys of a route, generated by genroutes.py
+ *
+ * Keys are matched with a perfect hash on their length and 3 sampled
+ * bytes (first, middle, last), see query_schema_hash().
+ */
+struct query_schema
+{
+	const struct query_schema_key *keys;
+	uint8_t count;
+
+	/* Perfect hash table, contains key index + 1, 0 if empty */
+	const uint8_t *table;
+	uint8_t bits;
+	uint32_t seed;
+};
+
+#define QUERY_KEY(_n, _t) \
+	{ \
+		.name = _n, \
+		.len = sizeof(_n) - 1u, \
+		.type = _t, \
+	}
+
+#define QUERY_SCHEMA(_ks, _kc, _tb, _bits, _seed) \
+	{ \
+		.keys = _ks, \
+		.count = _kc, \
+		.table = _tb, \
+		.bits = _bits, \
+		.seed = _seed, \
+	}
+
+union query_value
+{
+	uint32_t uint;
+	char *str;
+};
+
+static inline uint32_t query_schema_hash(const char *key,
+					 size_t len,
+					 uint32_t seed,
+					 uint8_t bits)
+{
+	const uint32_t x = (uint32_t)(len & 0xffu) |
+			   ((uint32_t)(uint8_t)key[0u] << 8u) |
+			   ((uint32_t)(uint8_t)key[len / 2u] << 16u) |
+			   ((uint32_t)(uint8_t)key[len - 1u] << 24u);
+
+	return (x * seed) >> (32u - bits);
+}
+
+/**
+ * @brief Parse a query string straight into typed values, following schema
+ *
+ * values[i] receives the value of schema->keys[i] and bit i of present is set
+ * if the key has been found. ARG_STR values are NUL-terminated and
+ * percent-decoded in place. Unknown keys and keys without value are
+ * ignored, the first occurrence of a key wins.
+ *
+ * @param schema Expected keys (at most 32)
+ * @param url Query string, arguments are parsed after the last '?'
+ * @param values Array of at least schema->count elements
+ * @param present Bitmask of keys found
+ * @return int Number of keys found, -EINVAL if a numeric value is invalid
+ */
+int query_schema_parse(const struct query_schema *schema,
+		       char *url,
+		       union query_value values[],
+		       uint32_t *present);
+
+
 /* HTTP routes tree structure, functions and parser */
 
 struct route_part
@@ -66,11 +393,63 @@ struct route_part
 #define ROUTE_ARG_UINT		(1u << 4u)
 #define ROUTE_ARG_HEX		(1u << 5u)
 #define ROUTE_ARG_STR		(1u << 6u)
-#define ROUTE_ARG_MASK		(ROUTE_ARG_UINT | ROUTE_ARG_HEX | ROUTE_ARG_STR)
+#define ROUTE_ARG_INT		(1u << 8u)
+#define ROUTE_ARG_NUMBER	(ROUTE_ARG_UINT | ROUTE_ARG_HEX | ROUTE_ARG_INT)
+#define ROUTE_ARG_MASK		(ROUTE_ARG_NUMBER | ROUTE_ARG_STR)
+
+/* With a numeric type, 64-bit value (uint64 or sint64 result) */
+#define ROUTE_ARG_64		(1u << 9u)
 
 #define ROUTE_IS_LEAF		(1u << 7u)
 #define ROUTE_IS_LEAF_MASK	(1u << 7u)
 
+/**
+ * @brief Static children lookup of a section, generated by genroutes.py
+ *
+ * Static children are sorted by name (children sharing a name are
+ * contiguous) and typed (ARG_*) children are grouped at the end of the
+ * section. Either a perfect hash table (names are hashed as query keys, see
+ * query_schema_hash()) or a first-byte jump table is used.
+ *
+ * This changes match priority: a static child is always tried before the
+ * typed ones, even if a typed child comes first in the routes file or in
+ * a hand-written table. Hand-written tables given a lookup must follow the
+ * same order. Indexes are 8-bit, a section has at most 255 children.
+ */
+struct route_lookup
+{
+	/* Perfect hash table, index of the first child with the name + 1,
+	 * 0 if empty. NULL if the jump table is used. */
+	const uint8_t *table;
+	uint8_t bits;
+	uint32_t seed;
+
+	/* Children whose name starts with byte lo + i are
+	 * [jump[i], jump[i + 1]), count + 1 entries */
+	const uint8_t *jump;
+	uint8_t lo;
+	uint16_t count;
+
+	/* Index of the first typed child, children count if none */
+	uint8_t typed;
+};
+
+#define ROUTE_HASH(_tb, _bits, _seed, _typed) \
+	{ \
+		.table = _tb, \
+		.bits = _bits, \
+		.seed = _seed, \
+		.typed = _typed, \
+	}
+
+#define ROUTE_JUMP(_jt, _lo, _cnt, _typed) \
+	{ \
+		.jump = _jt, \
+		.lo = _lo, \
+		.count = _cnt, \
+		.typed = _typed, \
+	}
+
 struct route_descr
 {
 	uint32_t flags;
@@ -80,10 +459,17 @@ struct route_descr
 		struct {
 			const struct route_descr *list;
 			size_t count;
+
+			/* Static children lookup, optional (no extra size, leaf
+			 * members are as large) */
+			const struct route_lookup *lookup;
 		} children;
 		struct {
 			void (*resp_handler)(void);
 			void (*req_handler)(void);
+
+			/* Expected query arguments, optional */
+			const struct query_schema *query;
 		};
 	};
 
@@ -102,6 +488,19 @@ struct route_descr
 		.user_data = (uint32_t)_u, \
 	}
 
+#define LEAF_QUERY(_p, _fl, _rp, _rq, _q, _u) \
+	{ \
+		.flags = _fl | IS_LEAF, \
+		.part = { \
+			.str = _p, \
+			.len = sizeof(_p) - 1u, \
+		}, \
+		.req_handler = (void (*)(void))_rq, \
+		.resp_handler = (void (*)(void))_rp, \
+		.query = _q, \
+		.user_data = (uint32_t)_u, \
+	}
+
 #define SECTION(_p, _fl, _ls, _cc, _u) \
 	{ \
 		.flags = _fl, \
@@ -116,6 +515,21 @@ struct route_descr
 		.user_data = (uint32_t)_u, \
 	}
 
+#define SECTION_LOOKUP(_p, _fl, _ls, _cc, _lk, _u) \
+	{ \
+		.flags = _fl, \
+		.part = { \
+			.str = _p, \
+			.len = sizeof(_p) - 1u, \
+		}, \
+		.children = { \
+			.list = _ls, \
+			.count = _cc, \
+			.lookup = _lk, \
+		}, \
+		.user_data = (uint32_t)_u, \
+	}
+
 typedef int (*route_parser_cb_t)(struct route_part *s,
 				 void *user_data);
 
@@ -123,6 +537,38 @@ int route_parse(char *url,
 		route_parser_cb_t cb,
 		void *user_data);
 
+/**
+ * @brief Split the path of an URL into segments, same rules as route_parse()
+ *
+ * Segments are located with a vectorized scan and sliced in place.
+ *
+ * @param url URL to split, the path ends at the first '?'
+ * @param parts Array to fill with segments
+ * @param count Size of the array, number of segments on success
+ * @return int Number of chars parsed, -ENOMEM if parts is too small, in
+ *  which case url is left untouched
+ */
+int route_segment(char *url, struct route_part parts[], size_t *count);
+
+/**
+ * @brief Same as route_segment(), but the path is normalized in place
+ *
+ * In the same scan: percent-escapes are decoded, empty segments
+ * (duplicate slashes) and "." segments are dropped, ".." removes the
+ * previous segment (RFC 3986 dot-segment removal, never above the root).
+ * Decoded '/' does not split segments and escaped dots count as dots.
+ * Used by route_tree_resolve() if CONFIG_EMBEDC_URL_PARSER_NORMALIZE
+ * is enabled.
+ *
+ * @param url URL to normalize and split, the path ends at the first '?'
+ * @param parts Array to fill with segments
+ * @param count Size of the array, number of segments on success (may be 0)
+ * @return int Number of chars parsed, -ENOMEM if parts is too small (the
+ *  path is normalized in place nonetheless), -EINVAL if the path contains
+ *  an escaped NUL ("%00")
+ */
+int route_segment_normalize(char *url, struct route_part parts[], size_t *count);
+
 /**
  * @brief Callback for route_iterate
  *
@@ -153,21 +599,40 @@ struct route_parse_result
 {
 	uint32_t depth;
 
+	/* Node index, only set by route_packed_resolve() */
+	uint16_t node;
+
 	const struct route_descr *descr;
 
 	union {
 		uint32_t uint;
 		int32_t sint;
+		uint64_t uint64;
+		int64_t sint64;
 		char *str;
 		void *arg;
+
+		/* String and static parts, with their length */
+		struct route_part part;
 	};
 };
 
+/**
+ * @brief Size of a root given as a section (e.g. root_section generated by
+ * genroutes.py), whose children are resolved with the section lookup
+ *
+ * Accepted by route_tree_resolve(), route_tree_resolve_const(),
+ * route_tree_resolve_backtrack(), route_tree_resolve_batch(),
+ * route_stream_init() and in the versions given to route_cache_resolve().
+ * Other functions take a root array.
+ */
+#define ROUTE_ROOT_SECTION SIZE_MAX
+
 /**
  * @brief Parse route and fill route_parse_result array
  *
  * @param root Root of routes tree
- * @param size Size of routes tree
+ * @param size Size of routes tree, ROUTE_ROOT_SECTION if root is a section
  * @param url URL to parse
  * @param results array of route_parse_result
  * @param results_size size of results array
@@ -182,6 +647,234 @@ const struct route_descr *route_tree_resolve(const struct route_descr *root,
 					     size_t *results_count,
 					     char **query_string);
 
+/**
+ * @brief Same as route_tree_resolve(), but the URL is left untouched
+ *
+ * Can resolve from a shared read-only buffer, or resolve the same URL
+ * against several trees. String arguments are not NUL-terminated, use
+ * the part member (str + len) of the results. Numeric arguments must be
+ * valid over the whole segment.
+ *
+ * @param url URL to resolve, not necessarily NUL-terminated
+ * @param len Length of the URL
+ * @param query_string Query string (after the '?'), url + len if none
+ */
+const struct route_descr *route_tree_resolve_const(const struct route_descr *root,
+						   size_t size,
+						   const char *url,
+						   size_t len,
+						   uint32_t flags,
+						   uint32_t mask,
+						   struct route_parse_result *results,
+						   size_t *results_count,
+						   const char **query_string);
+
+/**
+ * @brief Same as route_tree_resolve_const(), from the children of a section
+ * (size ROUTE_ROOT_SECTION)
+ *
+ * @param section Section whose children are resolved, not part of the results
+ */
+const struct route_descr *route_section_resolve_const(const struct route_descr *section,
+						      const char *url,
+						      size_t len,
+						      uint32_t flags,
+						      uint32_t mask,
+						      struct route_parse_result *results,
+						      size_t *results_count,
+						      const char **query_string);
+
+/**
+ * @brief Same as route_tree_resolve_const(), but a dead end is not final
+ *
+ * Static children are tried before typed ones, whatever their order. If
+ * the rest of the path can't be resolved from a child, the next matching
+ * child is tried (e.g. /test/:s/mystr is reachable even if /test/payload
+ * is a section). Sections which failed from a segment are remembered, so
+ * children lists shared between sections are not walked again.
+ *
+ * Up to CONFIG_EMBEDC_URL_PARSER_BACKTRACK_MEMO failed children lists are
+ * remembered per segment. If no more distinct lists are reached from a
+ * segment, each list is walked at most once per segment and the work is
+ * bounded by the number of segments times the size of the tree. Past that,
+ * the oldest ones are forgotten and may be walked again.
+ *
+ * Paths with more than CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS segments
+ * (the depth of the backtracking stack) are resolved as with
+ * route_tree_resolve_const().
+ */
+const struct route_descr *route_tree_resolve_backtrack(const struct route_descr *root,
+						       size_t size,
+						       const char *url,
+						       size_t len,
+						       uint32_t flags,
+						       uint32_t mask,
+						       struct route_parse_result *results,
+						       size_t *results_count,
+						       const char **query_string);
+
+#ifndef CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH
+#define CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH 7u
+#endif /* CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH */
+
+#ifndef CONFIG_EMBEDC_URL_PARSER_CACHE_PATH_MAX
+#define CONFIG_EMBEDC_URL_PARSER_CACHE_PATH_MAX 48u
+#endif /* CONFIG_EMBEDC_URL_PARSER_CACHE_PATH_MAX */
+
+#ifndef CONFIG_EMBEDC_URL_PARSER_CACHE_LINE_SIZE
+#define CONFIG_EMBEDC_URL_PARSER_CACHE_LINE_SIZE 64u
+#endif /* CONFIG_EMBEDC_URL_PARSER_CACHE_LINE_SIZE */
+
+/**
+ * @brief Resolved path, results are rebuilt from the descriptors and the
+ * offsets of the segments
+ */
+struct route_cache_entry
+{
+	/* Entries start on a cache line */
+	_Alignas(CONFIG_EMBEDC_URL_PARSER_CACHE_LINE_SIZE) uint32_t hash;
+	uint32_t flags;
+	uint32_t mask;
+
+	/* Path length, 0 results if the entry is empty */
+	uint8_t len;
+	uint8_t parts;
+	uint8_t count;
+
+	/* Offset of each segment in the path */
+	uint8_t offsets[CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH];
+
+	const struct route_descr *descrs[CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH];
+
+	char path[CONFIG_EMBEDC_URL_PARSER_CACHE_PATH_MAX];
+};
+
+/**
+ * @brief Tree published in a route table, embedded in the caller's
+ * allocation
+ *
+ * Also identifies the tree of a route cache, a static tree is given in a
+ * version which is never published (generation 0).
+ */
+struct route_table_version
+{
+	const struct route_descr *root;
+	size_t size;
+
+	/* Called once no reader can access the tree anymore, can be NULL */
+	void (*release)(struct route_table_version *version);
+
+	/* Set by route_table_publish(), differs between versions published in
+	 * the same memory */
+	uint32_t generation;
+
+	/* Reserved */
+	uint32_t retire_epoch;
+	struct route_table_version *next;
+};
+
+#define ROUTE_TABLE_VERSION(_root, _size, _release) \
+	{ \
+		.root = _root, \
+		.size = _size, \
+		.release = _release, \
+	}
+
+/**
+ * @brief Direct-mapped cache of resolved paths, not thread-safe (one per
+ * worker)
+ */
+struct route_cache
+{
+	struct route_cache_entry *entries;
+
+	/* Power of 2 */
+	size_t count;
+
+	/* Tree the entries were resolved in */
+	const struct route_table_version *version;
+	uint32_t generation;
+	const struct route_descr *root;
+	size_t size;
+
+	uint32_t hits;
+	uint32_t misses;
+};
+
+/**
+ * @brief Initialize a resolve cache
+ *
+ * @param entries Array of count entries
+ * @param count Number of entries, power of 2
+ * @return int 0 on success, negative value on error
+ */
+int route_cache_init(struct route_cache *cache,
+		     struct route_cache_entry entries[],
+		     size_t count);
+
+/**
+ * @brief Drop all entries, to be called if the tree they were resolved in
+ * is modified in place
+ *
+ * Entries are dropped automatically when another version, or the same one
+ * published again, is resolved.
+ */
+void route_cache_invalidate(struct route_cache *cache);
+
+/**
+ * @brief Same as route_tree_resolve_const(), through the cache, in the tree
+ * of a version
+ *
+ * Paths are matched with their bytes and the flags (with mask). Paths
+ * longer than CONFIG_EMBEDC_URL_PARSER_CACHE_PATH_MAX or deeper than
+ * CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH are resolved but not cached.
+ *
+ * Entries are dropped if the version, its generation or its tree differ
+ * from the previous call, so a version from route_table_read_lock() can be
+ * given directly.
+ */
+const struct route_descr *route_cache_resolve(struct route_cache *cache,
+					      const struct route_table_version *version,
+					      const char *url,
+					      size_t len,
+					      uint32_t flags,
+					      uint32_t mask,
+					      struct route_parse_result *results,
+					      size_t *results_count,
+					      const char **query_string);
+
+/**
+ * @brief URL of a batch and its resolution
+ */
+struct route_batch
+{
+	const char *url;
+	size_t len;
+	uint32_t flags;
+
+	/* Array of results_count results, results_count is set to the number
+	 * of results filled */
+	struct route_parse_result *results;
+	size_t results_count;
+
+	/* NULL if not resolved */
+	const struct route_descr *leaf;
+	const char *query_string;
+};
+
+/**
+ * @brief Resolve URLs as route_tree_resolve_const(), walks of several URLs
+ * are interleaved (CONFIG_EMBEDC_URL_PARSER_BATCH_WIDTH) and the next
+ * children of each walk are prefetched.
+ *
+ * @return size_t Number of URLs resolved, 0 if the tree or batch is NULL
+ */
+size_t route_tree_resolve_batch(const struct route_descr *root,
+				size_t size,
+				uint32_t mask,
+				struct route_batch batch[],
+				size_t count);
+
 int route_build_url(char *url,
 		    size_t url_size,
 		    const struct route_descr **parents,
@@ -199,14 +892,46 @@ int route_results_get_arg_by_index(const struct route_parse_result *results,
 			  uint32_t arg_flags,
 			  void **arg);
 
+/**
+ * @brief Get the numeric argument of a result, widened to 64 bits
+ *
+ * :i arguments are sign-extended. Arguments with ROUTE_ARG_64 are only
+ * returned if arg_flags has it, so they are never truncated by the 32-bit
+ * helpers below.
+ *
+ * @param arg_flags Accepted argument types (ROUTE_ARG_NUMBER flags), with
+ *  ROUTE_ARG_64 to accept 64-bit arguments
+ * @return int 0 on success, -ENOENT if not found, -EINVAL if the argument
+ *  has another type
+ */
+int route_results_find_value(const struct route_parse_result *results,
+			     size_t count,
+			     const struct route_descr *search,
+			     uint32_t arg_flags,
+			     uint64_t *value);
+
+/**
+ * @brief Same as route_results_find_value(), for the result at index
+ */
+int route_results_get_value_by_index(const struct route_parse_result *results,
+				     size_t count,
+				     uint32_t index,
+				     uint32_t arg_flags,
+				     uint64_t *value);
+
 static inline int
 route_results_find_uint(const struct route_parse_result *results,
 			size_t count,
 			const struct route_descr *search,
 			uint32_t *uint)
 {
-	return route_results_find_arg(
-		results, count, search, ROUTE_ARG_UINT, (void **)uint);
+	uint64_t v;
+	const int ret = route_results_find_value(results, count, search,
+						 ROUTE_ARG_UINT, &v);
+	if (!ret)
+		*uint = (uint32_t)v;
+
+	return ret;
 }
 
 static inline int
@@ -219,19 +944,62 @@ route_results_find_hex(const struct route_parse_result *results,
 		results, count, search, ROUTE_ARG_HEX, (void **)hex);
 }
 
+/* :i values are given as their 32-bit two's complement */
 static inline int
 route_results_find_number(const struct route_parse_result *results,
 			  size_t count,
 			  const struct route_descr *search,
 			  uint32_t *n)
 {
-	return route_results_find_arg(
-		results,
-		count,
-		search,
-		ROUTE_ARG_UINT | ROUTE_ARG_HEX,
-		(void **)n
-	);
+	uint64_t v;
+	const int ret = route_results_find_value(results, count, search,
+						 ROUTE_ARG_NUMBER, &v);
+	if (!ret)
+		*n = (uint32_t)v;
+
+	return ret;
+}
+
+static inline int
+route_results_find_sint(const struct route_parse_result *results,
+			size_t count,
+			const struct route_descr *search,
+			int32_t *sint)
+{
+	uint64_t v;
+	const int ret = route_results_find_value(results, count, search,
+						 ROUTE_ARG_INT, &v);
+	if (!ret)
+		*sint = (int32_t)(int64_t)v;
+
+	return ret;
+}
+
+/* 32-bit and 64-bit :u and :x arguments */
+static inline int
+route_results_find_u64(const struct route_parse_result *results,
+		       size_t count,
+		       const struct route_descr *search,
+		       uint64_t *n)
+{
+	return route_results_find_value(results, count, search,
+					ROUTE_ARG_UINT | ROUTE_ARG_HEX | ROUTE_ARG_64, n);
+}
+
+/* 32-bit and 64-bit :i arguments */
+static inline int
+route_results_find_s64(const struct route_parse_result *results,
+		       size_t count,
+		       const struct route_descr *search,
+		       int64_t *n)
+{
+	uint64_t v;
+	const int ret = route_results_find_value(results, count, search,
+						 ROUTE_ARG_INT | ROUTE_ARG_64, &v);
+	if (!ret)
+		*n = (int64_t)v;
+
+	return ret;
 }
 
 static inline int
@@ -250,8 +1018,13 @@ route_results_get_uint_by_index(const struct route_parse_result *results,
 		       uint32_t index,
 		       uint32_t *uint)
 {
-	return route_results_get_arg_by_index(
-		results, count, index, ROUTE_ARG_UINT, (void **)uint);
+	uint64_t v;
+	const int ret = route_results_get_value_by_index(results, count, index,
+							 ROUTE_ARG_UINT, &v);
+	if (!ret)
+		*uint = (uint32_t)v;
+
+	return ret;
 }
 
 static inline int
@@ -264,19 +1037,61 @@ route_results_get_hex_by_index(const struct route_parse_result *results,
 		results, count, index, ROUTE_ARG_HEX, (void **)hex);
 }
 
+/* :i values are given as their 32-bit two's complement */
 static inline int
 route_results_get_number_by_index(const struct route_parse_result *results,
 			 size_t count,
 			 uint32_t index,
 			 uint32_t *n)
 {
-	return route_results_get_arg_by_index(
-		results,
-		count,
-		index,
-		ROUTE_ARG_UINT | ROUTE_ARG_HEX,
-		(void **)n
-	);
+	uint64_t v;
+	const int ret = route_results_get_value_by_index(results, count, index,
+							 ROUTE_ARG_NUMBER, &v);
+	if (!ret)
+		*n = (uint32_t)v;
+
+	return ret;
+}
+
+static inline int
+route_results_get_sint_by_index(const struct route_parse_result *results,
+				size_t count,
+				uint32_t index,
+				int32_t *sint)
+{
+	uint64_t v;
+	const int ret = route_results_get_value_by_index(results, count, index,
+							 ROUTE_ARG_INT, &v);
+	if (!ret)
+		*sint = (int32_t)(int64_t)v;
+
+	return ret;
+}
+
+static inline int
+route_results_get_u64_by_index(const struct route_parse_result *results,
+			       size_t count,
+			       uint32_t index,
+			       uint64_t *n)
+{
+	return route_results_get_value_by_index(results, count, index,
+						ROUTE_ARG_UINT | ROUTE_ARG_HEX | ROUTE_ARG_64,
+						n);
+}
+
+static inline int
+route_results_get_s64_by_index(const struct route_parse_result *results,
+			       size_t count,
+			       uint32_t index,
+			       int64_t *n)
+{
+	uint64_t v;
+	const int ret = route_results_get_value_by_index(results, count, index,
+							 ROUTE_ARG_INT | ROUTE_ARG_64, &v);
+	if (!ret)
+		*n = (int64_t)v;
+
+	return ret;
 }
 
 static inline int
@@ -296,4 +1111,682 @@ route_results_get(const struct route_parse_result *results,
 		  uint32_t arg_flags,
 		  void **arg);
 
+/* Resumable URL parser, fed by chunks */
+
+enum url_stream_event
+{
+	URL_STREAM_SEGMENT,	/* Path segment, in key */
+	URL_STREAM_QUERY_ARG,	/* Query argument, key and value */
+	URL_STREAM_END,		/* End of URL, no token */
+	URL_STREAM_PATH_END,	/* End of path, no token */
+};
+
+struct url_stream_token
+{
+	const char *key;
+	size_t key_len;
+
+	/* NULL if the argument has no value */
+	const char *value;
+	size_t value_len;
+};
+
+/**
+ * @brief Callback for url_stream_feed(), token is only valid during the call
+ *
+ * @return int 0 to continue, any other value aborts parsing and is returned
+ *  by url_stream_feed()/url_stream_end()
+ */
+typedef int (*url_stream_cb_t)(enum url_stream_event event,
+			       const struct url_stream_token *token,
+			       void *user_data);
+
+enum url_stream_state
+{
+	URL_STREAM_STATE_LEADING,	/* Leading '/' of the path */
+	URL_STREAM_STATE_PATH,
+	URL_STREAM_STATE_QUERY,
+	URL_STREAM_STATE_DONE,
+};
+
+struct url_stream
+{
+	uint8_t state;
+
+	/* Current token, offsets are relative to its first byte */
+	bool has_value;
+	size_t key_len;
+	size_t value_off;
+
+	/* Bytes of the current token received in previous chunks */
+	char *buf;
+	size_t size;
+	size_t len;
+
+	url_stream_cb_t cb;
+	void *user_data;
+};
+
+/**
+ * @brief Initialize a resumable URL parser
+ *
+ * Path segments are split as route_parse() does (leading '/' ignored,
+ * empty segments reported). Query arguments are split as query_args_parse()
+ * does, except that '?' is not a delimiter in the query string, arguments
+ * with an empty key are not reported.
+ *
+ * Only tokens spanning several chunks are copied to buf, which bounds the
+ * length of a segment or query argument.
+ *
+ * @param s Parser state
+ * @param buf Buffer for tokens spanning several chunks
+ * @param size Size of the buffer
+ * @param cb Callback called for each completed token
+ * @param user_data User data passed to cb
+ */
+void url_stream_init(struct url_stream *s,
+		     char *buf,
+		     size_t size,
+		     url_stream_cb_t cb,
+		     void *user_data);
+
+/**
+ * @brief Feed a chunk of the URL
+ *
+ * A space ends the URL (request line), remaining bytes are not consumed.
+ *
+ * @return int Number of bytes consumed, -ENOMEM if a token doesn't fit in buf,
+ *  callback return value if it aborted parsing
+ */
+int url_stream_feed(struct url_stream *s, const char *data, size_t len);
+
+/**
+ * @brief Signal the end of the URL, report the pending token if any
+ *
+ * @return int 0 on success, negative value on error
+ */
+int url_stream_end(struct url_stream *s);
+
+static inline bool url_stream_done(const struct url_stream *s)
+{
+	return s->state == URL_STREAM_STATE_DONE;
+}
+
+/* Streaming application/x-www-form-urlencoded body parser */
+
+enum form_stream_state
+{
+	FORM_STREAM_STATE_KEY,
+	FORM_STREAM_STATE_VALUE,
+};
+
+/**
+ * @brief Callback for form_stream_feed(), token is only valid during the call
+ *
+ * A value spanning several chunks is reported in several parts, all but
+ * the last one with complete set to false. Parts never split a
+ * percent-escape, so each one can be decoded with query_value_decode().
+ * Key is already decoded. Value is NULL if the argument has no value.
+ *
+ * @return int 0 to continue, any other value aborts parsing
+ */
+typedef int (*form_stream_cb_t)(const struct url_stream_token *token,
+				bool complete,
+				void *user_data);
+
+struct form_stream
+{
+	uint8_t state;
+
+	/* Value of an argument with an empty key, not reported */
+	bool skip;
+
+	/* Key of the current argument, followed by the held back bytes of
+	 * an incomplete percent-escape at the end of the previous chunk.
+	 */
+	char *buf;
+	size_t size;
+	size_t len;
+	size_t key_len;
+
+	form_stream_cb_t cb;
+	void *user_data;
+};
+
+/**
+ * @brief Initialize a form body parser
+ *
+ * Arguments are separated by '&', the key ends at the first '=', later
+ * ones belong to the value as with url_stream.
+ * Memory is bounded by buf, which must hold the longest key plus 3 bytes,
+ * values are not buffered.
+ */
+void form_stream_init(struct form_stream *s,
+		      char *buf,
+		      size_t size,
+		      form_stream_cb_t cb,
+		      void *user_data);
+
+/**
+ * @brief Feed a chunk of the body
+ *
+ * @return int Number of bytes consumed, -ENOMEM if a key doesn't fit in buf,
+ *  callback return value if it aborted parsing
+ */
+int form_stream_feed(struct form_stream *s, const char *data, size_t len);
+
+/**
+ * @brief Signal the end of the body, report the pending argument if any
+ *
+ * @return int 0 on success, negative value on error
+ */
+int form_stream_end(struct form_stream *s);
+
+/* Incremental route resolution */
+
+struct route_stream
+{
+	struct url_stream url;
+
+	/* Walk state, private to the resolver */
+	const struct route_descr *descr;
+	size_t child_count;
+	const struct route_lookup *lookup;
+	uint32_t flags;
+	uint32_t mask;
+	uint32_t depth;
+
+	struct route_parse_result *results;
+	size_t results_size;
+	size_t results_remaining;
+
+	/* Buffer, string arguments are stored at its beginning, the rest is
+	 * used to carry segments spanning several chunks.
+	 */
+	char *buf;
+	size_t size;
+	size_t strs_len;
+
+	const struct route_descr *leaf;
+
+	/* 0 while resolving, 1 if resolved, negative value on error */
+	int status;
+};
+
+/**
+ * @brief Initialize an incremental route resolver
+ *
+ * Path bytes are fed with route_stream_feed() as they arrive, the tree is
+ * walked each time a segment is complete. String arguments are copied
+ * (NUL-terminated) to buf, other results point to the route descriptors.
+ *
+ * @param rs Resolver state
+ * @param root Root of routes tree
+ * @param size Size of routes tree, ROUTE_ROOT_SECTION if root is a section
+ * @param flags Flags value to match (e.g. method)
+ * @param mask Flags mask to match
+ * @param results Array of route_parse_result
+ * @param results_size Size of results array
+ * @param buf Buffer for string arguments and segments spanning several chunks
+ * @param buf_size Size of the buffer
+ */
+void route_stream_init(struct route_stream *rs,
+		       const struct route_descr *root,
+		       size_t size,
+		       uint32_t flags,
+		       uint32_t mask,
+		       struct route_parse_result *results,
+		       size_t results_size,
+		       char *buf,
+		       size_t buf_size);
+
+/**
+ * @brief Feed a chunk of the URL (see url_stream_feed())
+ *
+ * @return int Number of bytes consumed, -ENOENT as soon as the path can't
+ *  match any route, other negative value on error
+ */
+int route_stream_feed(struct route_stream *rs, const char *data, size_t len);
+
+/**
+ * @brief Signal the end of the URL
+ *
+ * @return int 0 on success, -ENOENT if no route matches
+ */
+int route_stream_end(struct route_stream *rs);
+
+/**
+ * @brief Get the matched leaf, available as soon as the path ended
+ *
+ * @param rs Resolver state
+ * @param results_count Number of results filled, optional
+ * @return const struct route_descr* Leaf, NULL if not (yet) resolved
+ */
+static inline const struct route_descr *
+route_stream_leaf(const struct route_stream *rs, size_t *results_count)
+{
+	if (rs->status <= 0)
+		return NULL;
+
+	if (results_count)
+		*results_count = rs->results_size - rs->results_remaining;
+
+	return rs->leaf;
+}
+
+/* Radix index over route tables, built at runtime */
+
+#define ROUTE_INDEX_NONE 0xffffu
+
+struct route_index_node
+{
+	/* Label, points to the name of a descriptor */
+	const char *label;
+	uint16_t len;
+
+	/* Children nodes, contiguous and sorted by the first byte of their label */
+	uint16_t children;
+	uint16_t child_count;
+
+	/* Static children whose name ends at this node, in section order */
+	uint16_t refs;
+	uint16_t ref_count;
+};
+
+struct route_index_ref
+{
+	/* Position of the child in its section */
+	uint16_t pos;
+
+	/* Index of the child section, ROUTE_INDEX_NONE if leaf */
+	uint16_t section;
+};
+
+struct route_index_section
+{
+	const struct route_descr *list;
+	uint16_t count;
+
+	/* Radix tree over the static children, ROUTE_INDEX_NONE if none */
+	uint16_t node;
+
+	/* Typed (ARG_*) children refs, in section order */
+	uint16_t typed;
+	uint16_t typed_count;
+};
+
+/**
+ * @brief Index over a route tree, its arrays are stored in the buffer given
+ * to route_tree_compile(). Section 0 is the root.
+ */
+struct route_index
+{
+	struct route_index_section *sections;
+	struct route_index_node *nodes;
+	struct route_index_ref *refs;
+
+	uint16_t section_count;
+	uint16_t node_count;
+	uint16_t ref_count;
+};
+
+/**
+ * @brief Build a radix index over an existing route tree
+ *
+ * Static children of each section are sorted and their names stored in a
+ * compressed trie (shared prefixes merged), labels point to the names of
+ * the descriptors. The tree must not change while the index is used.
+ *
+ * @param root Root of routes tree
+ * @param size Size of routes tree
+ * @param index Index to initialize
+ * @param buf Buffer receiving the index arrays, aligned for pointers,
+ *  NULL to get the required size
+ * @param buf_size Size of the buffer
+ * @return int Required size in bytes, -ENOMEM if buf is too small,
+ *  -E2BIG if the tree is too large for 16-bit indexes
+ */
+int route_tree_compile(const struct route_descr *root,
+		       size_t size,
+		       struct route_index *index,
+		       void *buf,
+		       size_t buf_size);
+
+/**
+ * @brief Same as route_tree_resolve_const(), using an index
+ *
+ * Children are tried in the same order as route_tree_resolve_const(), only
+ * the static children with the segment name and the typed ones are tried.
+ */
+const struct route_descr *route_index_resolve(const struct route_index *index,
+					      const char *url,
+					      size_t len,
+					      uint32_t flags,
+					      uint32_t mask,
+					      struct route_parse_result *results,
+					      size_t *results_count,
+					      const char **query_string);
+
+/* Packed route tables (genroutes.py --packed) */
+
+struct route_packed_leaf
+{
+	void (*resp_handler)(void);
+	void (*req_handler)(void);
+	const struct query_schema *query;
+	uint32_t user_data;
+};
+
+#define ROUTE_PACKED_LEAF(_rp, _rq, _q, _u) \
+	{ \
+		.resp_handler = (void (*)(void))_rp, \
+		.req_handler = (void (*)(void))_rq, \
+		.query = _q, \
+		.user_data = (uint32_t)_u, \
+	}
+
+/**
+ * @brief Route tree stored as a structure of arrays, indexed by node
+ *
+ * Children of a section are contiguous nodes, the children of the root
+ * are nodes [0, root_count).
+ *
+ * Only route_packed_resolve() and the route_packed_*() helpers below work
+ * on packed tables. Functions walking route_descr trees (route_tree_*(),
+ * route_build_url(), route_tree_compile(), ...) don't, generate descriptors
+ * for routes which need them.
+ */
+struct route_packed
+{
+	/* Names, NUL-terminated and deduplicated */
+	const char *pool;
+
+	/* Name offset in pool, name length and flags of each node */
+	const uint16_t *name;
+	const uint8_t *len;
+	const uint16_t *flags;
+
+	/* Section: first child node, leaf: index in leaves */
+	const uint16_t *index;
+
+	/* Section: children count */
+	const uint16_t *count;
+
+	const struct route_packed_leaf *leaves;
+
+	/* User data of each node, only read for sections, NULL if they all
+	 * have 0 */
+	const uint32_t *user_data;
+
+	uint16_t root_count;
+	uint16_t node_count;
+};
+
+#define ROUTE_PACKED(_pool, _name, _len, _fl, _idx, _cnt, _lv, _ud, _rc, _nc) \
+	{ \
+		.pool = _pool, \
+		.name = _name, \
+		.len = _len, \
+		.flags = _fl, \
+		.index = _idx, \
+		.count = _cnt, \
+		.leaves = _lv, \
+		.user_data = _ud, \
+		.root_count = _rc, \
+		.node_count = _nc, \
+	}
+
+/**
+ * @brief Same as route_tree_resolve_const(), on packed tables
+ *
+ * Results have no descriptor (descr is NULL), matched nodes are identified
+ * by their node index: get arguments with route_packed_results_get(), or
+ * with the route_results_*() functions after route_packed_expand().
+ *
+ * @return int Node index of the leaf, negative value on error
+ */
+int route_packed_resolve(const struct route_packed *pk,
+			 const char *url,
+			 size_t len,
+			 uint32_t flags,
+			 uint32_t mask,
+			 struct route_parse_result *results,
+			 size_t *results_count,
+			 const char **query_string);
+
+/**
+ * @brief Same as route_results_get(), on the results of
+ * route_packed_resolve()
+ */
+int route_packed_results_get(const struct route_packed *pk,
+			     const struct route_parse_result *results,
+			     size_t count,
+			     const char *name,
+			     uint32_t arg_flags,
+			     void **arg);
+
+/**
+ * @brief Build the route descriptor of a packed node
+ *
+ * Sections have no children list (only their count).
+ */
+void route_packed_descr(const struct route_packed *pk,
+			uint16_t node,
+			struct route_descr *descr);
+
+/**
+ * @brief Point the results of route_packed_resolve() to descriptors built
+ * in descrs, so they can be used as the ones of route_tree_resolve()
+ *
+ * @param descrs Array of count descriptors
+ */
+void route_packed_expand(const struct route_packed *pk,
+			 struct route_parse_result *results,
+			 size_t count,
+			 struct route_descr descrs[]);
+
+static inline const struct route_packed_leaf *
+route_packed_leaf(const struct route_packed *pk, uint16_t node)
+{
+	if ((pk->flags[node] & ROUTE_IS_LEAF_MASK) != ROUTE_IS_LEAF)
+		return NULL;
+
+	return &pk->leaves[pk->index[node]];
+}
+
+/* Runtime route registration */
+
+/* Node of a tree being built, in the builder arena */
+struct route_builder_node
+{
+	struct route_builder_node *children;
+	struct route_builder_node *last;
+	struct route_builder_node *next;
+	size_t child_count;
+
+	struct route_part part;
+	uint32_t flags;
+	uint32_t user_data;
+
+	/* Order of registration of the route */
+	uint32_t seq;
+
+	void (*resp_handler)(void);
+	void (*req_handler)(void);
+};
+
+/**
+ * @brief Builds a route tree from route strings, all memory is taken from
+ * a single arena given by the caller
+ */
+struct route_tree_builder
+{
+	uint8_t *buf;
+	size_t size;
+	size_t used;
+
+	/* Routes added */
+	uint32_t seq;
+
+	struct route_builder_node root;
+};
+
+/**
+ * @brief Initialize a builder
+ *
+ * @param arena Buffer receiving the nodes, names and final tree, aligned
+ * for pointers
+ * @param size Size of the arena
+ * @return int 0 on success, negative value on error
+ */
+int route_tree_builder_init(struct route_tree_builder *builder,
+			    void *arena,
+			    size_t size);
+
+/**
+ * @brief Add a route, as described in routes.txt (e.g.
+ * "GET /devices/caniot/:u/attribute/:x")
+ *
+ * Typed parts are :u, :x, :i (with a "64" suffix for 64-bit values) and
+ * :s. Routes are only appended, they are merged when the tree is built: a
+ * route added twice (same path and method) is ignored, the first one is
+ * kept. Until then, each route takes its name and a node per segment in
+ * the arena.
+ *
+ * @return int 0 on success (also for a route added twice), -ENOMEM if the
+ * arena is full (the builder is left unchanged), negative value on error
+ */
+int route_tree_builder_add(struct route_tree_builder *builder,
+			   const char *route,
+			   void (*resp_handler)(void),
+			   void (*req_handler)(void),
+			   uint32_t user_data);
+
+/**
+ * @brief Build the route_descr tree, in the arena
+ *
+ * Static children of each section are sorted by name, typed children
+ * follow in order of first registration of their name. No route can be
+ * added afterwards, the tree is valid as long as the arena is.
+ *
+ * On -ENOMEM, the routes are kept (merged) and the builder stays usable.
+ *
+ * @return int 0 on success, -ENOMEM if the arena can't hold the tree
+ */
+int route_tree_builder_finish(struct route_tree_builder *builder,
+			      const struct route_descr **root,
+			      size_t *size);
+
+/* Generated route matchers (genroutes.py --matcher) */
+
+#if defined(CONFIG_EMBEDC_URL_PARSER_MATCHER)
+
+/**
+ * @brief State of a generated matcher, same rules as route_tree_resolve_const()
+ *
+ * Generated code reads segments with route_match_next() and compares them
+ * inline, these helpers only carry the results.
+ */
+struct route_match
+{
+	const char *url;
+	size_t len;
+
+	/* Start of the next segment, end of the path */
+	size_t pos;
+	size_t end;
+
+	/* Whether a segment follows the current one */
+	bool more;
+
+	/* Current segment */
+	struct route_part part;
+
+	struct route_parse_result *result;
+	size_t remaining;
+	uint32_t depth;
+
+	uint32_t flags;
+	uint32_t mask;
+};
+
+/**
+ * @brief Initialize a generated matcher
+ *
+ * @return int 0 on success, -EINVAL if an argument is invalid
+ */
+int route_match_init(struct route_match *m,
+		     const char *url,
+		     size_t len,
+		     uint32_t flags,
+		     uint32_t mask,
+		     struct route_parse_result *results,
+		     size_t count);
+
+/**
+ * @brief Read the next segment, it is stored as the part of the current result
+ *
+ * @return true if there is a segment and a result to store it
+ */
+bool route_match_next(struct route_match *m);
+
+/**
+ * @brief Parse the current segment as ARG_UINT, ARG_HEX (whole segment)
+ */
+bool route_match_uint(struct route_match *m);
+bool route_match_hex(struct route_match *m);
+bool route_match_number(struct route_match *m, uint32_t flags);
+
+/**
+ * @brief Set the number of results and the query string of a generated matcher
+ *
+ * @return const struct route_descr* leaf
+ */
+const struct route_descr *route_match_finish(struct route_match *m,
+					     const struct route_descr *leaf,
+					     size_t *results_count,
+					     const char **query_string);
+
+static inline bool route_match_flags(const struct route_match *m,
+				     const struct route_descr *descr)
+{
+	return (descr->flags & m->mask) == (m->flags & m->mask);
+}
+
+/* Commit the current segment to descr */
+static inline void route_match_push(struct route_match *m,
+				    const struct route_descr *descr)
+{
+	m->result->depth = ++m->depth;
+	m->result->descr = descr;
+	m->result = --m->remaining > 0u ? m->result + 1u : NULL;
+}
+
+/* Commit the current segment to a leaf, which must be the last segment */
+static inline const struct route_descr *route_match_leaf(struct route_match *m,
+							 const struct route_descr *descr)
+{
+	route_match_push(m, descr);
+
+	return m->more ? NULL : descr;
+}
+
+/* Select the unnamed leaf of a section, once all segments are matched */
+static inline const struct route_descr *route_match_unnamed(struct route_match *m,
+							    const struct route_descr *descr)
+{
+	if (!m->result)
+		return NULL;
+
+	m->result->depth = m->depth + 1u;
+	m->result->descr = descr;
+	m->result->part.str = m->url + m->end;
+	m->result->part.len = 0u;
+	m->remaining--;
+
+	return descr;
+}
+
+#endif /* CONFIG_EMBEDC_URL_PARSER_MATCHER */
+
 #endif /* _EMBEDC_URL_PARSER_H_ */
\ No newline at end of file
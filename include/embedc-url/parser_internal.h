@@ -18,6 +18,9 @@
 #define ARG_UINT 	ROUTE_ARG_UINT 	
 #define ARG_HEX 	ROUTE_ARG_HEX 
 #define ARG_STR 	ROUTE_ARG_STR 
+#define ARG_INT 	ROUTE_ARG_INT
+#define ARG_64 		ROUTE_ARG_64
+#define ARG_NUMBER 	ROUTE_ARG_NUMBER
 #define ARG_MASK 	ROUTE_ARG_MASK 
 
 #define IS_LEAF		ROUTE_IS_LEAF
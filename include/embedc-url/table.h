@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _EMBEDC_URL_TABLE_H_
+#define _EMBEDC_URL_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include <embedc-url/parser.h>
+
+/* Hot-swappable route table, epoch-based reclamation */
+
+/* Epoch of a reader outside of read sections, never a table epoch */
+#define ROUTE_TABLE_EPOCH_IDLE 0u
+
+/**
+ * @brief Reader of a route table, one per worker thread
+ */
+struct route_table_reader
+{
+	/* Epoch of the read section, ROUTE_TABLE_EPOCH_IDLE if none, alone
+	 * on its cache line */
+	_Alignas(CONFIG_EMBEDC_URL_PARSER_CACHE_LINE_SIZE) atomic_uint epoch;
+};
+
+struct route_table
+{
+	_Atomic(struct route_table_version *) current;
+
+	/* Current epoch, wraps around skipping ROUTE_TABLE_EPOCH_IDLE */
+	atomic_uint epoch;
+
+	/* Generation of the last version published (writer side) */
+	uint32_t generation;
+
+	struct route_table_reader *readers;
+	size_t reader_count;
+
+	/* Versions replaced, waiting for their readers (writer side) */
+	struct route_table_version *retired;
+};
+
+/**
+ * @brief Initialize a route table
+ *
+ * @param readers Array of reader_count readers, one per worker thread
+ * @param version First tree published
+ * @return int 0 on success, negative value on error
+ */
+int route_table_init(struct route_table *table,
+		     struct route_table_reader readers[],
+		     size_t reader_count,
+		     struct route_table_version *version);
+
+/**
+ * @brief Enter a read section and get the current tree, lock-free
+ *
+ * The tree, and results resolved in it, are valid until
+ * route_table_read_unlock(). Read sections of a reader must not be nested.
+ */
+const struct route_table_version *route_table_read_lock(struct route_table *table,
+							struct route_table_reader *reader);
+
+static inline void route_table_read_unlock(struct route_table_reader *reader)
+{
+	atomic_store_explicit(&reader->epoch, ROUTE_TABLE_EPOCH_IDLE, memory_order_release);
+}
+
+/**
+ * @brief Publish a new tree, the previous one is released once all readers
+ * have left the read sections in which they could access it
+ *
+ * Writers must be serialized by the caller.
+ *
+ * @return int Number of versions still waiting to be released
+ */
+int route_table_publish(struct route_table *table,
+			struct route_table_version *version);
+
+/**
+ * @brief Release the replaced versions no reader can access anymore
+ *
+ * Called by route_table_publish(), can be called periodically by the
+ * writer.
+ *
+ * @return int Number of versions still waiting to be released
+ */
+int route_table_reclaim(struct route_table *table);
+
+#endif /* _EMBEDC_URL_TABLE_H_ */
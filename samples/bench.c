@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Resolver timings on the sample routes, e.g. ./sample_bench 1000000 */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "routes.h"
+
+#define RESULTS_COUNT 10u
+#define BATCH_COUNT 64u
+#define BUILDER_ROUTES 5000u
+
+struct request {
+	uint32_t method;
+	const char *url;
+};
+
+static const struct request requests[] = {
+	{GET, "/devices/caniot/12/endpoint/0/telemetry"},
+	{GET, "/metrics"},
+	{GET, "/info"},
+	{POST, "/test/route_args/1/2/3"},
+	{GET, "/devices/caniot/23/attribute/EEff"},
+	{DELETE, "/files/lua"},
+	{GET, "/devices/xiaomi?limit=10&cursor=ff&q=a"},
+	{GET, "/unknown/path"},
+};
+
+static volatile uintptr_t sink;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void report(const char *name, double start, size_t ops)
+{
+	printf("%-10s %8.1f ns/url\n", name, (now_ns() - start) / (double)ops);
+}
+
+static void bench_single(const char *name, size_t n,
+			 const struct route_descr *(*resolve)(const struct request *req,
+							       struct route_parse_result *results,
+							       size_t *count))
+{
+	struct route_parse_result results[RESULTS_COUNT];
+	const double start = now_ns();
+
+	for (size_t i = 0u; i < n; i++) {
+		size_t count = ARRAY_SIZE(results);
+
+		sink += (uintptr_t)resolve(&requests[i % ARRAY_SIZE(requests)],
+					   results, &count);
+	}
+
+	report(name, start, n);
+}
+
+static const struct route_descr *resolve_const(const struct request *req,
+					       struct route_parse_result *results,
+					       size_t *count)
+{
+	return route_tree_resolve_const(routes_root, routes_root_size, req->url,
+					strlen(req->url), req->method, METHODS_MASK,
+					results, count, NULL);
+}
+
+static const struct route_descr *resolve_section(const struct request *req,
+						 struct route_parse_result *results,
+						 size_t *count)
+{
+	return route_section_resolve_const(routes_root_section, req->url,
+					   strlen(req->url), req->method, METHODS_MASK,
+					   results, count, NULL);
+}
+
+static const struct route_descr *resolve_backtrack(const struct request *req,
+						   struct route_parse_result *results,
+						   size_t *count)
+{
+	return route_tree_resolve_backtrack(routes_root, routes_root_size, req->url,
+					    strlen(req->url), req->method, METHODS_MASK,
+					    results, count, NULL);
+}
+
+static const struct route_descr *resolve_matcher(const struct request *req,
+						 struct route_parse_result *results,
+						 size_t *count)
+{
+	return routes_match(req->url, strlen(req->url), req->method, METHODS_MASK,
+			    results, count, NULL);
+}
+
+static struct route_cache cache;
+static struct route_cache_entry cache_entries[64u];
+static const struct route_table_version *cache_version;
+
+static const struct route_descr *resolve_cache(const struct request *req,
+					       struct route_parse_result *results,
+					       size_t *count)
+{
+	return route_cache_resolve(&cache, cache_version, req->url, strlen(req->url),
+				   req->method, METHODS_MASK, results, count, NULL);
+}
+
+static void bench_batch(size_t n)
+{
+	static struct route_parse_result results[BATCH_COUNT][RESULTS_COUNT];
+	struct route_batch batch[BATCH_COUNT];
+	const double start = now_ns();
+	size_t done = 0u;
+
+	while (done < n) {
+		for (size_t i = 0u; i < BATCH_COUNT; i++) {
+			const struct request *const req =
+				&requests[(done + i) % ARRAY_SIZE(requests)];
+
+			batch[i] = (struct route_batch) {
+				.url = req->url,
+				.len = strlen(req->url),
+				.flags = req->method,
+				.results = results[i],
+				.results_count = RESULTS_COUNT,
+			};
+		}
+
+		sink += route_tree_resolve_batch(routes_root, routes_root_size,
+						 METHODS_MASK, batch, BATCH_COUNT);
+		done += BATCH_COUNT;
+	}
+
+	report("batch", start, done);
+}
+
+static void bench_builder(void)
+{
+	static _Alignas(void *) unsigned char arena[4u << 20u];
+	struct route_tree_builder builder;
+	const struct route_descr *root;
+	size_t size;
+	char route[128u];
+	int ret;
+
+	const double start = now_ns();
+
+	ret = route_tree_builder_init(&builder, arena, sizeof(arena));
+	for (size_t i = 0u; !ret && i < BUILDER_ROUTES; i++) {
+		snprintf(route, sizeof(route), "GET /plugin%zu/api/v%zu/item%zu/:u",
+			 i % 200u, i % 7u, i);
+		ret = route_tree_builder_add(&builder, route, rest_info, NULL, 0u);
+	}
+	if (!ret)
+		ret = route_tree_builder_finish(&builder, &root, &size);
+
+	printf("%-10s %8.3f ms for %u routes (%d)\n", "builder",
+	       (now_ns() - start) / 1e6, BUILDER_ROUTES, ret);
+}
+
+int main(int argc, char *argv[])
+{
+	const size_t n = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000000u;
+	const struct route_table_version version =
+		ROUTE_TABLE_VERSION(routes_root, routes_root_size, NULL);
+
+	cache_version = &version;
+	route_cache_init(&cache, cache_entries, ARRAY_SIZE(cache_entries));
+
+	bench_single("const", n, resolve_const);
+	bench_single("section", n, resolve_section);
+	bench_single("backtrack", n, resolve_backtrack);
+	bench_single("matcher", n, resolve_matcher);
+	bench_single("cache", n, resolve_cache);
+	bench_batch(n);
+	bench_builder();
+
+	return 0;
+}
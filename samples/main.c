@@ -21,18 +21,20 @@ int main(void)
 		"/test/customSTR/mystr",
 		"/test/customSTR/azer/qsd",
 		"/files?x=23",
+		"/devices/xiaomi?limit=10&cursor=ff&unknown=1&q=a+b%21",
 	};
 
-	for (uint32_t i = 0; i < ARRAY_SIZE(results); i++) {
+	for (uint32_t i = 0; i < ARRAY_SIZE(urls); i++) {
 		char *url = urls[i];
 		printf("\nP url=%s\n", url);
 
 		size_t results_count = ARRAY_SIZE(results);
+		char *query_string = NULL;
 		const struct route_descr *leaf =
-			route_tree_resolve(routes_root, routes_root_size, url,
+			route_tree_resolve(routes_root_section, ROUTE_ROOT_SECTION, url,
 					   GET, METHODS_MASK,
 					   results, &results_count,
-					   NULL);
+					   &query_string);
 
 		printf("leaf=%p (%s)\n", (void *)leaf, leaf ? leaf->part.str : "");
 
@@ -48,6 +50,25 @@ int main(void)
 				}
 			}
 		}
+
+		if (leaf && leaf->query) {
+			union query_value values[32u];
+			uint32_t present;
+			int count = query_schema_parse(leaf->query, query_string,
+						       values, &present);
+			printf("query_schema_parse() = %d\n", count);
+
+			for (uint8_t k = 0u; k < leaf->query->count; k++) {
+				const struct query_schema_key *key = &leaf->query->keys[k];
+				if (!(present & BIT(k))) {
+					continue;
+				} else if (key->type == ARG_STR) {
+					printf("\t%s=%s\n", key->name, values[k].str);
+				} else {
+					printf("\t%s=%u\n", key->name, values[k].uint);
+				}
+			}
+		}
 	}
 
 	char query_strs[][100u] = {
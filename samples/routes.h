@@ -7,6 +7,19 @@
 extern const struct route_descr *const routes_root;
 extern const size_t routes_root_size;
 
+/* Root section, with the root lookup, resolved with ROUTE_ROOT_SECTION as
+ * size */
+extern const struct route_descr *const routes_root_section;
+
+/* Generated matcher, same as route_tree_resolve_const() on routes_root */
+const struct route_descr *routes_match(const char *url,
+				       size_t len,
+				       uint32_t flags,
+				       uint32_t mask,
+				       struct route_parse_result *results,
+				       size_t *results_count,
+				       const char **query_string);
+
 void web_server_index_html(void);
 void web_server_files_html(void);
 void rest_info(void);
@@ -37,18 +37,33 @@ static const struct route_descr root_test_route_args[] = {
 
 #if defined(CONFIG_HTTP_TEST_SERVER)
 static const struct route_descr root_test[] = {
-	LEAF("messaging", POST, http_test_messaging, NULL, 0u),
-	LEAF("streaming", POST, http_test_streaming, NULL, 0u),
-	SECTION("route_args", 0u, root_test_route_args, 
-		ARRAY_SIZE(root_test_route_args), 0u),
 	LEAF("big_payload", POST, http_test_big_payload, NULL, 0u),
 	LEAF("headers", GET, http_test_headers, NULL, 0u),
+	LEAF("messaging", POST, http_test_messaging, NULL, 0u),
 	LEAF("payload", GET, http_test_payload, NULL, 0u),
+	SECTION("route_args", 0u, root_test_route_args, 
+		ARRAY_SIZE(root_test_route_args), 0u),
+	LEAF("streaming", POST, http_test_streaming, NULL, 0u),
 	SECTION(":s", ARG_STR, root_test_zs, 
 		ARRAY_SIZE(root_test_zs), 0u),
 };
+
+static const uint8_t root_test_lookup_table[] = {
+	5u, 4u, 0u, 2u, 3u, 0u, 1u, 6u,
+};
+
+static const struct route_lookup root_test_lookup =
+	ROUTE_HASH(root_test_lookup_table, 3u, 0xe3e70683u, 6u);
 #endif
 
+static const struct route_descr root_room[] = {
+	LEAF(":u", GET | ARG_UINT, rest_room_devices_list, NULL, 0u),
+};
+
+static const struct route_descr root_lua[] = {
+	LEAF("execute", POST, rest_lua_run_script, NULL, 0u),
+};
+
 #if defined(CONFIG_CAN_INTERFACE)
 static const struct route_descr root_if_can[] = {
 	LEAF(":x", POST | ARG_HEX, rest_if_can, NULL, 0u),
@@ -62,12 +77,8 @@ static const struct route_descr root_if[] = {
 };
 #endif
 
-static const struct route_descr root_demo[] = {
-	LEAF("json", GET, rest_demo_json, NULL, 0u),
-};
-
-static const struct route_descr root_lua[] = {
-	LEAF("execute", POST, rest_lua_run_script, NULL, 0u),
+static const struct route_descr root_ha[] = {
+	LEAF("stats", GET, rest_ha_stats, NULL, 0u),
 };
 
 static const struct route_descr root_files[] = {
@@ -77,27 +88,10 @@ static const struct route_descr root_files[] = {
 	LEAF("lua", DELETE, rest_fs_remove_lua_script, NULL, 0u),
 };
 
-static const struct route_descr root_ha[] = {
-	LEAF("stats", GET, rest_ha_stats, NULL, 0u),
-};
-
-#if defined(CONFIG_CANIOT_CONTROLLER)
-static const struct route_descr root_devices_caniot_zu_attribute[] = {
-	LEAF(":x", GET | ARG_HEX, rest_devices_caniot_attr_read_write, NULL, 0u),
-	LEAF(":x", PUT | ARG_HEX, rest_devices_caniot_attr_read_write, NULL, 0u),
-};
-#endif
-
 #if defined(CONFIG_CANIOT_CONTROLLER)
 static const struct route_descr root_devices_caniot_zu_endpoint_zu[] = {
-	LEAF("telemetry", GET, rest_devices_caniot_telemetry, NULL, 0u),
 	LEAF("command", POST, rest_devices_caniot_command, NULL, 0u),
-};
-#endif
-
-#if defined(CONFIG_CANIOT_CONTROLLER)
-static const struct route_descr root_devices_caniot_zu_endpoint_blc[] = {
-	LEAF("command", POST, rest_devices_caniot_blc_command, NULL, 0u),
+	LEAF("telemetry", GET, rest_devices_caniot_telemetry, NULL, 0u),
 };
 #endif
 
@@ -113,25 +107,38 @@ static const struct route_descr root_devices_caniot_zu_endpoint_blc0[] = {
 };
 #endif
 
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr root_devices_caniot_zu_endpoint_blc[] = {
+	LEAF("command", POST, rest_devices_caniot_blc_command, NULL, 0u),
+};
+#endif
+
 #if defined(CONFIG_CANIOT_CONTROLLER)
 static const struct route_descr root_devices_caniot_zu_endpoint[] = {
+	SECTION("blc", 0u, root_devices_caniot_zu_endpoint_blc, 
+		ARRAY_SIZE(root_devices_caniot_zu_endpoint_blc), 0u),
 	SECTION("blc0", 0u, root_devices_caniot_zu_endpoint_blc0, 
 		ARRAY_SIZE(root_devices_caniot_zu_endpoint_blc0), 0u),
 	SECTION("blc1", 0u, root_devices_caniot_zu_endpoint_blc1, 
 		ARRAY_SIZE(root_devices_caniot_zu_endpoint_blc1), 0u),
-	SECTION("blc", 0u, root_devices_caniot_zu_endpoint_blc, 
-		ARRAY_SIZE(root_devices_caniot_zu_endpoint_blc), 0u),
 	SECTION(":u", ARG_UINT, root_devices_caniot_zu_endpoint_zu, 
 		ARRAY_SIZE(root_devices_caniot_zu_endpoint_zu), 0u),
 };
 #endif
 
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr root_devices_caniot_zu_attribute[] = {
+	LEAF(":x", GET | ARG_HEX, rest_devices_caniot_attr_read_write, NULL, 0u),
+	LEAF(":x", PUT | ARG_HEX, rest_devices_caniot_attr_read_write, NULL, 0u),
+};
+#endif
+
 #if defined(CONFIG_CANIOT_CONTROLLER)
 static const struct route_descr root_devices_caniot_zu[] = {
-	SECTION("endpoint", 0u, root_devices_caniot_zu_endpoint, 
-		ARRAY_SIZE(root_devices_caniot_zu_endpoint), 0u),
 	SECTION("attribute", 0u, root_devices_caniot_zu_attribute, 
 		ARRAY_SIZE(root_devices_caniot_zu_attribute), 0u),
+	SECTION("endpoint", 0u, root_devices_caniot_zu_endpoint, 
+		ARRAY_SIZE(root_devices_caniot_zu_endpoint), 0u),
 };
 #endif
 
@@ -143,24 +150,60 @@ static const struct route_descr root_devices_caniot[] = {
 };
 #endif
 
+static const struct query_schema_key query_root_devices_xiaomi_get_keys[] = {
+	QUERY_KEY("limit", ARG_UINT),
+	QUERY_KEY("cursor", ARG_HEX),
+	QUERY_KEY("q", ARG_STR),
+};
+
+static const uint8_t query_root_devices_xiaomi_get_table[] = {
+	3u, 0u, 2u, 1u,
+};
+
+static const struct query_schema query_root_devices_xiaomi_get =
+	QUERY_SCHEMA(query_root_devices_xiaomi_get_keys, 3u,
+		     query_root_devices_xiaomi_get_table, 2u, 0xc2094cadu);
+
 static const struct route_descr root_devices[] = {
 	LEAF("", GET, rest_devices_list, NULL, 0u),
 	LEAF("", POST, rest_devices_list, NULL, 0u),
-	LEAF("xiaomi", GET, rest_xiaomi_records, NULL, 0u),
+#if defined(CONFIG_CANIOT_CONTROLLER)
+	SECTION("caniot", 0u, root_devices_caniot, 
+		ARRAY_SIZE(root_devices_caniot), 0u),
+#endif
 #if defined(CONFIG_CANIOT_CONTROLLER)
 	LEAF("garage", GET, rest_devices_garage_get, NULL, 0u),
 #endif
 #if defined(CONFIG_CANIOT_CONTROLLER)
 	LEAF("garage", POST, rest_devices_garage_post, NULL, 0u),
+#endif
+	LEAF_QUERY("xiaomi", GET, rest_xiaomi_records, NULL, &query_root_devices_xiaomi_get, 0u),
+};
+
+enum {
+	root_devices_i0 = 0,
+	root_devices_i1 = root_devices_i0 + 1,
+	root_devices_i2 = root_devices_i1 + 1,
+#if defined(CONFIG_CANIOT_CONTROLLER)
+	root_devices_i3 = root_devices_i2 + 1,
+#else
+	root_devices_i3 = root_devices_i2,
 #endif
 #if defined(CONFIG_CANIOT_CONTROLLER)
-	SECTION("caniot", 0u, root_devices_caniot, 
-		ARRAY_SIZE(root_devices_caniot), 0u),
+	root_devices_i4 = root_devices_i3 + 1,
+#else
+	root_devices_i4 = root_devices_i3,
 #endif
+#if defined(CONFIG_CANIOT_CONTROLLER)
+	root_devices_i5 = root_devices_i4 + 1,
+#else
+	root_devices_i5 = root_devices_i4,
+#endif
+	root_devices_i6 = root_devices_i5 + 1,
 };
 
-static const struct route_descr root_room[] = {
-	LEAF(":u", GET | ARG_UINT, rest_room_devices_list, NULL, 0u),
+static const struct route_descr root_demo[] = {
+	LEAF("json", GET, rest_demo_json, NULL, 0u),
 };
 
 #if defined(CONFIG_CREDS_FLASH)
@@ -171,45 +214,744 @@ static const struct route_descr root_credentials[] = {
 
 static const struct route_descr root[] = {
 	LEAF("", GET, web_server_index_html, NULL, 0u),
-	LEAF("index.html", GET, web_server_index_html, NULL, 0u),
-	LEAF("fetch", GET, web_server_files_html, NULL, 0u),
-	LEAF("info", GET, rest_info, NULL, 0u),
 #if defined(CONFIG_CREDS_FLASH)
 	SECTION("credentials", 0u, root_credentials, 
 		ARRAY_SIZE(root_credentials), 0u),
 #endif
-	LEAF("metrics", GET, prometheus_metrics, NULL, 0u),
-	LEAF("metrics_controller", GET, prometheus_metrics_controller, NULL, 0u),
-	LEAF("metrics_demo", GET, prometheus_metrics_demo, NULL, 0u),
-	SECTION("room", 0u, root_room, 
-		ARRAY_SIZE(root_room), 0u),
-	SECTION("devices", 0u, root_devices, 
-		ARRAY_SIZE(root_devices), 0u),
-	SECTION("ha", 0u, root_ha, 
-		ARRAY_SIZE(root_ha), 0u),
-	SECTION("files", 0u, root_files, 
-		ARRAY_SIZE(root_files), 0u),
-	SECTION("lua", 0u, root_lua, 
-		ARRAY_SIZE(root_lua), 0u),
 	SECTION("demo", 0u, root_demo, 
 		ARRAY_SIZE(root_demo), 0u),
+	SECTION("devices", 0u, root_devices, 
+		ARRAY_SIZE(root_devices), 0u),
 #if defined(CONFIG_DFU)
 	LEAF("dfu", POST, http_dfu_image_upload, http_dfu_image_upload_response, 0u),
 #endif
 #if defined(CONFIG_DFU)
 	LEAF("dfu", GET, http_dfu_status, NULL, 0u),
 #endif
+	LEAF("fetch", GET, web_server_files_html, NULL, 0u),
+	SECTION("files", 0u, root_files, 
+		ARRAY_SIZE(root_files), 0u),
+	SECTION("ha", 0u, root_ha, 
+		ARRAY_SIZE(root_ha), 0u),
 #if defined(CONFIG_CAN_INTERFACE)
 	SECTION("if", 0u, root_if, 
 		ARRAY_SIZE(root_if), 0u),
 #endif
+	LEAF("index.html", GET, web_server_index_html, NULL, 0u),
+	LEAF("info", GET, rest_info, NULL, 0u),
+	SECTION("lua", 0u, root_lua, 
+		ARRAY_SIZE(root_lua), 0u),
+	LEAF("metrics", GET, prometheus_metrics, NULL, 0u),
+	LEAF("metrics_controller", GET, prometheus_metrics_controller, NULL, 0u),
+	LEAF("metrics_demo", GET, prometheus_metrics_demo, NULL, 0u),
+	SECTION("room", 0u, root_room, 
+		ARRAY_SIZE(root_room), 0u),
 #if defined(CONFIG_HTTP_TEST_SERVER)
-	SECTION("test", 0u, root_test, 
-		ARRAY_SIZE(root_test), 0u),
+	SECTION_LOOKUP("test", 0u, root_test, 
+		ARRAY_SIZE(root_test), &root_test_lookup, 0u),
 #endif
 };
 
+enum {
+	root_i0 = 0,
+	root_i1 = root_i0 + 1,
+#if defined(CONFIG_CREDS_FLASH)
+	root_i2 = root_i1 + 1,
+#else
+	root_i2 = root_i1,
+#endif
+	root_i3 = root_i2 + 1,
+	root_i4 = root_i3 + 1,
+#if defined(CONFIG_DFU)
+	root_i5 = root_i4 + 1,
+#else
+	root_i5 = root_i4,
+#endif
+#if defined(CONFIG_DFU)
+	root_i6 = root_i5 + 1,
+#else
+	root_i6 = root_i5,
+#endif
+	root_i7 = root_i6 + 1,
+	root_i8 = root_i7 + 1,
+	root_i9 = root_i8 + 1,
+#if defined(CONFIG_CAN_INTERFACE)
+	root_i10 = root_i9 + 1,
+#else
+	root_i10 = root_i9,
+#endif
+	root_i11 = root_i10 + 1,
+	root_i12 = root_i11 + 1,
+	root_i13 = root_i12 + 1,
+	root_i14 = root_i13 + 1,
+	root_i15 = root_i14 + 1,
+	root_i16 = root_i15 + 1,
+	root_i17 = root_i16 + 1,
+#if defined(CONFIG_HTTP_TEST_SERVER)
+	root_i18 = root_i17 + 1,
+#else
+	root_i18 = root_i17,
+#endif
+};
+
+static const uint8_t root_lookup_table[] = {
+	0u, 0u, 0u, root_i1 + 1u, 0u, 0u, 0u, 0u, root_i7 + 1u, root_i10 + 1u, root_i17 + 1u, root_i11 + 1u, root_i16 + 1u, 0u, root_i13 + 1u, 0u, root_i6 + 1u, 0u, root_i15 + 1u, 0u, root_i3 + 1u, root_i8 + 1u, root_i4 + 1u, 0u, 0u, 0u, 0u, root_i12 + 1u, root_i9 + 1u, 0u, root_i14 + 1u, root_i2 + 1u,
+};
+
+static const struct route_lookup root_lookup =
+	ROUTE_HASH(root_lookup_table, 5u, 0x3590a2e5u, root_i18);
+
+static const struct route_descr root_section =
+	SECTION_LOOKUP("", 0u, root, ARRAY_SIZE(root), &root_lookup, 0u);
+
+#if defined(CONFIG_EMBEDC_URL_PARSER_MATCHER)
+
+#if defined(CONFIG_HTTP_TEST_SERVER)
+static const struct route_descr *routes_match_root_test_zs(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 5u:
+		if (!memcmp(m->part.str, "mystr", 5u)) {
+			if (route_match_flags(m, &root_test_zs[0u]))
+				return route_match_leaf(m, &root_test_zs[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_HTTP_TEST_SERVER)
+static const struct route_descr *routes_match_root_test_route_args_zu_zu(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	if (route_match_uint(m) && route_match_flags(m, &root_test_route_args_zu_zu[0u]))
+		return route_match_leaf(m, &root_test_route_args_zu_zu[0u]);
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_HTTP_TEST_SERVER)
+static const struct route_descr *routes_match_root_test_route_args_zu(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	if (route_match_uint(m)) {
+		route_match_push(m, &root_test_route_args_zu[0u]);
+		return routes_match_root_test_route_args_zu_zu(m);
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_HTTP_TEST_SERVER)
+static const struct route_descr *routes_match_root_test_route_args(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	if (route_match_uint(m)) {
+		route_match_push(m, &root_test_route_args[0u]);
+		return routes_match_root_test_route_args_zu(m);
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_HTTP_TEST_SERVER)
+static const struct route_descr *routes_match_root_test(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 7u:
+		if (!memcmp(m->part.str, "headers", 7u)) {
+			if (route_match_flags(m, &root_test[1u]))
+				return route_match_leaf(m, &root_test[1u]);
+		}
+		if (!memcmp(m->part.str, "payload", 7u)) {
+			if (route_match_flags(m, &root_test[3u]))
+				return route_match_leaf(m, &root_test[3u]);
+		}
+		break;
+	case 9u:
+		if (!memcmp(m->part.str, "messaging", 9u)) {
+			if (route_match_flags(m, &root_test[2u]))
+				return route_match_leaf(m, &root_test[2u]);
+		}
+		if (!memcmp(m->part.str, "streaming", 9u)) {
+			if (route_match_flags(m, &root_test[5u]))
+				return route_match_leaf(m, &root_test[5u]);
+		}
+		break;
+	case 10u:
+		if (!memcmp(m->part.str, "route_args", 10u)) {
+			route_match_push(m, &root_test[4u]);
+			return routes_match_root_test_route_args(m);
+		}
+		break;
+	case 11u:
+		if (!memcmp(m->part.str, "big_payload", 11u)) {
+			if (route_match_flags(m, &root_test[0u]))
+				return route_match_leaf(m, &root_test[0u]);
+		}
+		break;
+	}
+
+	route_match_push(m, &root_test[6u]);
+	return routes_match_root_test_zs(m);
+}
+#endif
+
+static const struct route_descr *routes_match_root_room(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	if (route_match_uint(m) && route_match_flags(m, &root_room[0u]))
+		return route_match_leaf(m, &root_room[0u]);
+
+	return NULL;
+}
+
+static const struct route_descr *routes_match_root_lua(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 7u:
+		if (!memcmp(m->part.str, "execute", 7u)) {
+			if (route_match_flags(m, &root_lua[0u]))
+				return route_match_leaf(m, &root_lua[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+#if defined(CONFIG_CAN_INTERFACE)
+static const struct route_descr *routes_match_root_if_can(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	if (route_match_hex(m) && route_match_flags(m, &root_if_can[0u]))
+		return route_match_leaf(m, &root_if_can[0u]);
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CAN_INTERFACE)
+static const struct route_descr *routes_match_root_if(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 3u:
+		if (!memcmp(m->part.str, "can", 3u)) {
+			route_match_push(m, &root_if[0u]);
+			return routes_match_root_if_can(m);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+static const struct route_descr *routes_match_root_ha(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 5u:
+		if (!memcmp(m->part.str, "stats", 5u)) {
+			if (route_match_flags(m, &root_ha[0u]))
+				return route_match_leaf(m, &root_ha[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+static const struct route_descr *routes_match_root_files(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		if (route_match_flags(m, &root_files[0u]))
+			return route_match_unnamed(m, &root_files[0u]);
+		if (route_match_flags(m, &root_files[1u]))
+			return route_match_unnamed(m, &root_files[1u]);
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 0u:
+		if (route_match_flags(m, &root_files[0u]))
+			return route_match_leaf(m, &root_files[0u]);
+		if (route_match_flags(m, &root_files[1u]))
+			return route_match_leaf(m, &root_files[1u]);
+		break;
+	case 3u:
+		if (!memcmp(m->part.str, "lua", 3u)) {
+			if (route_match_flags(m, &root_files[2u]))
+				return route_match_leaf(m, &root_files[2u]);
+			if (route_match_flags(m, &root_files[3u]))
+				return route_match_leaf(m, &root_files[3u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot_zu_endpoint_zu(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 7u:
+		if (!memcmp(m->part.str, "command", 7u)) {
+			if (route_match_flags(m, &root_devices_caniot_zu_endpoint_zu[0u]))
+				return route_match_leaf(m, &root_devices_caniot_zu_endpoint_zu[0u]);
+		}
+		break;
+	case 9u:
+		if (!memcmp(m->part.str, "telemetry", 9u)) {
+			if (route_match_flags(m, &root_devices_caniot_zu_endpoint_zu[1u]))
+				return route_match_leaf(m, &root_devices_caniot_zu_endpoint_zu[1u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot_zu_endpoint_blc1(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 7u:
+		if (!memcmp(m->part.str, "command", 7u)) {
+			if (route_match_flags(m, &root_devices_caniot_zu_endpoint_blc1[0u]))
+				return route_match_leaf(m, &root_devices_caniot_zu_endpoint_blc1[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot_zu_endpoint_blc0(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 7u:
+		if (!memcmp(m->part.str, "command", 7u)) {
+			if (route_match_flags(m, &root_devices_caniot_zu_endpoint_blc0[0u]))
+				return route_match_leaf(m, &root_devices_caniot_zu_endpoint_blc0[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot_zu_endpoint_blc(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 7u:
+		if (!memcmp(m->part.str, "command", 7u)) {
+			if (route_match_flags(m, &root_devices_caniot_zu_endpoint_blc[0u]))
+				return route_match_leaf(m, &root_devices_caniot_zu_endpoint_blc[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot_zu_endpoint(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 3u:
+		if (!memcmp(m->part.str, "blc", 3u)) {
+			route_match_push(m, &root_devices_caniot_zu_endpoint[0u]);
+			return routes_match_root_devices_caniot_zu_endpoint_blc(m);
+		}
+		break;
+	case 4u:
+		if (!memcmp(m->part.str, "blc0", 4u)) {
+			route_match_push(m, &root_devices_caniot_zu_endpoint[1u]);
+			return routes_match_root_devices_caniot_zu_endpoint_blc0(m);
+		}
+		if (!memcmp(m->part.str, "blc1", 4u)) {
+			route_match_push(m, &root_devices_caniot_zu_endpoint[2u]);
+			return routes_match_root_devices_caniot_zu_endpoint_blc1(m);
+		}
+		break;
+	}
+
+	if (route_match_uint(m)) {
+		route_match_push(m, &root_devices_caniot_zu_endpoint[3u]);
+		return routes_match_root_devices_caniot_zu_endpoint_zu(m);
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot_zu_attribute(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	if (route_match_hex(m) && route_match_flags(m, &root_devices_caniot_zu_attribute[0u]))
+		return route_match_leaf(m, &root_devices_caniot_zu_attribute[0u]);
+	if (route_match_hex(m) && route_match_flags(m, &root_devices_caniot_zu_attribute[1u]))
+		return route_match_leaf(m, &root_devices_caniot_zu_attribute[1u]);
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot_zu(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 8u:
+		if (!memcmp(m->part.str, "endpoint", 8u)) {
+			route_match_push(m, &root_devices_caniot_zu[1u]);
+			return routes_match_root_devices_caniot_zu_endpoint(m);
+		}
+		break;
+	case 9u:
+		if (!memcmp(m->part.str, "attribute", 9u)) {
+			route_match_push(m, &root_devices_caniot_zu[0u]);
+			return routes_match_root_devices_caniot_zu_attribute(m);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+#if defined(CONFIG_CANIOT_CONTROLLER)
+static const struct route_descr *routes_match_root_devices_caniot(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		if (route_match_flags(m, &root_devices_caniot[0u]))
+			return route_match_unnamed(m, &root_devices_caniot[0u]);
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 0u:
+		if (route_match_flags(m, &root_devices_caniot[0u]))
+			return route_match_leaf(m, &root_devices_caniot[0u]);
+		break;
+	}
+
+	if (route_match_uint(m)) {
+		route_match_push(m, &root_devices_caniot[1u]);
+		return routes_match_root_devices_caniot_zu(m);
+	}
+
+	return NULL;
+}
+#endif
+
+static const struct route_descr *routes_match_root_devices(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		if (route_match_flags(m, &root_devices[root_devices_i0]))
+			return route_match_unnamed(m, &root_devices[root_devices_i0]);
+		if (route_match_flags(m, &root_devices[root_devices_i1]))
+			return route_match_unnamed(m, &root_devices[root_devices_i1]);
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 0u:
+		if (route_match_flags(m, &root_devices[root_devices_i0]))
+			return route_match_leaf(m, &root_devices[root_devices_i0]);
+		if (route_match_flags(m, &root_devices[root_devices_i1]))
+			return route_match_leaf(m, &root_devices[root_devices_i1]);
+		break;
+	case 6u:
+		switch (m->part.str[0u]) {
+		case 'c':
+			if (!memcmp(m->part.str, "caniot", 6u)) {
+#if defined(CONFIG_CANIOT_CONTROLLER)
+				route_match_push(m, &root_devices[root_devices_i2]);
+				return routes_match_root_devices_caniot(m);
+#endif
+			}
+			break;
+		case 'g':
+			if (!memcmp(m->part.str, "garage", 6u)) {
+#if defined(CONFIG_CANIOT_CONTROLLER)
+				if (route_match_flags(m, &root_devices[root_devices_i3]))
+					return route_match_leaf(m, &root_devices[root_devices_i3]);
+#endif
+#if defined(CONFIG_CANIOT_CONTROLLER)
+				if (route_match_flags(m, &root_devices[root_devices_i4]))
+					return route_match_leaf(m, &root_devices[root_devices_i4]);
+#endif
+			}
+			break;
+		case 'x':
+			if (!memcmp(m->part.str, "xiaomi", 6u)) {
+				if (route_match_flags(m, &root_devices[root_devices_i5]))
+					return route_match_leaf(m, &root_devices[root_devices_i5]);
+			}
+			break;
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+static const struct route_descr *routes_match_root_demo(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 4u:
+		if (!memcmp(m->part.str, "json", 4u)) {
+			if (route_match_flags(m, &root_demo[0u]))
+				return route_match_leaf(m, &root_demo[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+#if defined(CONFIG_CREDS_FLASH)
+static const struct route_descr *routes_match_root_credentials(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 5u:
+		if (!memcmp(m->part.str, "flash", 5u)) {
+			if (route_match_flags(m, &root_credentials[0u]))
+				return route_match_leaf(m, &root_credentials[0u]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+#endif
+
+static const struct route_descr *routes_match_root(struct route_match *m)
+{
+	if (!route_match_next(m)) {
+		if (route_match_flags(m, &root[root_i0]))
+			return route_match_unnamed(m, &root[root_i0]);
+		return NULL;
+	}
+
+	switch (m->part.len) {
+	case 0u:
+		if (route_match_flags(m, &root[root_i0]))
+			return route_match_leaf(m, &root[root_i0]);
+		break;
+	case 2u:
+		if (!memcmp(m->part.str, "ha", 2u)) {
+			route_match_push(m, &root[root_i8]);
+			return routes_match_root_ha(m);
+		}
+		if (!memcmp(m->part.str, "if", 2u)) {
+#if defined(CONFIG_CAN_INTERFACE)
+			route_match_push(m, &root[root_i9]);
+			return routes_match_root_if(m);
+#endif
+		}
+		break;
+	case 3u:
+		if (!memcmp(m->part.str, "dfu", 3u)) {
+#if defined(CONFIG_DFU)
+			if (route_match_flags(m, &root[root_i4]))
+				return route_match_leaf(m, &root[root_i4]);
+#endif
+#if defined(CONFIG_DFU)
+			if (route_match_flags(m, &root[root_i5]))
+				return route_match_leaf(m, &root[root_i5]);
+#endif
+		}
+		if (!memcmp(m->part.str, "lua", 3u)) {
+			route_match_push(m, &root[root_i12]);
+			return routes_match_root_lua(m);
+		}
+		break;
+	case 4u:
+		switch (m->part.str[0u]) {
+		case 'd':
+			if (!memcmp(m->part.str, "demo", 4u)) {
+				route_match_push(m, &root[root_i2]);
+				return routes_match_root_demo(m);
+			}
+			break;
+		case 'i':
+			if (!memcmp(m->part.str, "info", 4u)) {
+				if (route_match_flags(m, &root[root_i11]))
+					return route_match_leaf(m, &root[root_i11]);
+			}
+			break;
+		case 'r':
+			if (!memcmp(m->part.str, "room", 4u)) {
+				route_match_push(m, &root[root_i16]);
+				return routes_match_root_room(m);
+			}
+			break;
+		case 't':
+			if (!memcmp(m->part.str, "test", 4u)) {
+#if defined(CONFIG_HTTP_TEST_SERVER)
+				route_match_push(m, &root[root_i17]);
+				return routes_match_root_test(m);
+#endif
+			}
+			break;
+		}
+		break;
+	case 5u:
+		if (!memcmp(m->part.str, "fetch", 5u)) {
+			if (route_match_flags(m, &root[root_i6]))
+				return route_match_leaf(m, &root[root_i6]);
+		}
+		if (!memcmp(m->part.str, "files", 5u)) {
+			route_match_push(m, &root[root_i7]);
+			return routes_match_root_files(m);
+		}
+		break;
+	case 7u:
+		if (!memcmp(m->part.str, "devices", 7u)) {
+			route_match_push(m, &root[root_i3]);
+			return routes_match_root_devices(m);
+		}
+		if (!memcmp(m->part.str, "metrics", 7u)) {
+			if (route_match_flags(m, &root[root_i13]))
+				return route_match_leaf(m, &root[root_i13]);
+		}
+		break;
+	case 10u:
+		if (!memcmp(m->part.str, "index.html", 10u)) {
+			if (route_match_flags(m, &root[root_i10]))
+				return route_match_leaf(m, &root[root_i10]);
+		}
+		break;
+	case 11u:
+		if (!memcmp(m->part.str, "credentials", 11u)) {
+#if defined(CONFIG_CREDS_FLASH)
+			route_match_push(m, &root[root_i1]);
+			return routes_match_root_credentials(m);
+#endif
+		}
+		break;
+	case 12u:
+		if (!memcmp(m->part.str, "metrics_demo", 12u)) {
+			if (route_match_flags(m, &root[root_i15]))
+				return route_match_leaf(m, &root[root_i15]);
+		}
+		break;
+	case 18u:
+		if (!memcmp(m->part.str, "metrics_controller", 18u)) {
+			if (route_match_flags(m, &root[root_i14]))
+				return route_match_leaf(m, &root[root_i14]);
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+const struct route_descr *routes_match(const char *url,
+				size_t len,
+				uint32_t flags,
+				uint32_t mask,
+				struct route_parse_result *results,
+				size_t *results_count,
+				const char **query_string)
+{
+	struct route_match m;
+
+	if (!results_count ||
+	    route_match_init(&m, url, len, flags, mask, results, *results_count))
+		return NULL;
+
+	return route_match_finish(&m, routes_match_root(&m),
+				  results_count, query_string);
+}
+
+#endif /* CONFIG_EMBEDC_URL_PARSER_MATCHER */
 /* ROUTES DEF END */
 
 const struct route_descr *const routes_root = root;
-const size_t routes_root_size = ARRAY_SIZE(root);
\ No newline at end of file
+const size_t routes_root_size = ARRAY_SIZE(root);
+const struct route_descr *const routes_root_section = &root_section;
\ No newline at end of file
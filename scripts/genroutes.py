@@ -13,6 +13,7 @@ from enum import IntEnum, IntFlag
 from abc import ABC, abstractmethod
 import re
 import argparse
+import random
 
 import logging
 l = logging.getLogger("genroutes")
@@ -39,12 +40,16 @@ class Flag(IntFlag):
     PUT = 1 << 2      # PUT
     DELETE = 1 << 3   # DELETE
 
+    # Values must match ROUTE_ARG_* in parser.h
     ARG_UINT = 1 << 4     # is unsigned int argument
-    ARG_STR = 1 << 5     # is str argument
-    ARG_HEX = 1 << 6     # is hex argument
+    ARG_HEX = 1 << 5     # is hex argument
+    ARG_STR = 1 << 6     # is str argument
 
     LEAF = 1 << 7  # is leaf
 
+    ARG_INT = 1 << 8     # is signed int argument
+    ARG_64 = 1 << 9      # 64-bit numeric argument
+
     def __str__(self) -> str:
         hidden_flags = [Flag.LEAF]
 
@@ -57,7 +62,7 @@ class Flag(IntFlag):
 
         return string
 
-ARGS_MASK = Flag.ARG_HEX | Flag.ARG_STR | Flag.ARG_UINT
+ARGS_MASK = Flag.ARG_HEX | Flag.ARG_STR | Flag.ARG_UINT | Flag.ARG_INT | Flag.ARG_64
 
 
 def part_name_to_arg_flags(part: str) -> Flag:
@@ -65,16 +70,73 @@ def part_name_to_arg_flags(part: str) -> Flag:
         "x": Flag.ARG_HEX,
         "s": Flag.ARG_STR,
         "u": Flag.ARG_UINT,
+        "i": Flag.ARG_INT,
     }
     m = parse_arg_descr(part)
     if m:
-        return arg_descr_table.get(m.groupdict().get("argpart"), Flag(0))
+        flags = arg_descr_table.get(m.group("argpart")[0], Flag(0))
+        if m.group("argbits"):
+            flags |= Flag.ARG_64
+        return flags
     else:
         return Flag(0)
 
 
 def parse_arg_descr(part: str) -> re.Match:
-    return re.match(r"^(?P<argname>[a-zA-Z0-9_]*)\:(?P<argpart>[xsu]{1})$", part)
+    """
+    Typed part: ":u", ":x", ":s", ":i", numeric types with a "64" suffix
+    (e.g. ":u64") are 64-bit.
+    """
+    return re.match(r"^(?P<argname>[a-zA-Z0-9_]*)\:"
+                    r"(?P<argpart>s|[xui](?P<argbits>64)?)$", part)
+
+
+QUERY_SCHEMA_MAX_KEYS = 32
+
+
+def query_schema_hash(key: str, seed: int, bits: int) -> int:
+    """
+    Must match query_schema_hash() in parser.h
+    """
+    b = key.encode()
+    n = len(b)
+    x = (n & 0xff) | (b[0] << 8) | (b[n // 2] << 16) | (b[n - 1] << 24)
+    return ((x * seed) & 0xffffffff) >> (32 - bits)
+
+
+def gen_query_perfect_hash(keys: List[str]) -> Tuple[int, int, List[int]]:
+    """
+    Find a seed for which query_schema_hash() has no collision over keys.
+
+    Returns (bits, seed, table), table contains key index + 1, 0 if empty.
+    """
+    samples = set()
+    for k in keys:
+        b = k.encode()
+        sample = (len(b), b[0], b[len(b) // 2], b[-1])
+        if sample in samples:
+            raise ValueError(f"Query keys can't be distinguished: {keys}")
+        samples.add(sample)
+
+    rnd = random.Random(0)  # deterministic output
+    bits = max(1, (len(keys) - 1).bit_length())
+
+    while True:
+        for _ in range(4096):
+            seed = rnd.getrandbits(32) | 1
+            table = [0] * (1 << bits)
+            for i, k in enumerate(keys):
+                h = query_schema_hash(k, seed, bits)
+                if table[h]:
+                    break
+                table[h] = i + 1
+            else:
+                return bits, seed, table
+        bits += 1
+
+
+# Minimum number of distinct static children names for a section lookup
+SECTION_LOOKUP_MIN_NAMES = 4
 
 
 @dataclass
@@ -88,6 +150,9 @@ class RouteRepr:
     conditions: set[str] = field(default_factory=set)
     user_data: str = "0u"
 
+    # expected query arguments: (key, arg type)
+    query: List[Tuple[str, str]] = field(default_factory=list)
+
     def unconditional(self) -> bool:
         return len(self.conditions) == 0
 
@@ -98,10 +163,12 @@ class RouteRepr:
             GET /demo/json -> rest_demo_json
             POST /dfu -> http_dfu_image_upload, http_dfu_image_upload_response (CONFIG_DFU) | 0x70u
             GET /dfu -> http_dfu_status (CONFIG_DFU) | REST
+            GET /devices/xiaomi?limit:u&cursor:x&q:s -> rest_xiaomi_records
         """
         rec = re.compile(
             r"^(?P<method>[a-zA-Z]+)\s"
-            r"/(?P<path>[a-zA-Z0-9_/:.]*)\s->\s"
+            r"/(?P<path>[a-zA-Z0-9_/:.]*)"
+            r"(\?(?P<query>[a-zA-Z0-9_]+:[usx](&[a-zA-Z0-9_]+:[usx])*))?\s->\s"
             r"(?P<req_handler>[a-zA-Z0-9_]+)\s?"
             r"(,\s(?P<resp_handler>[a-zA-Z0-9_]+)\s?)?"
             r"(\s\((?P<conditions>([A-Z_]+)((\s|,|,\s)[A-Z_]+)*)\))?"
@@ -125,6 +192,17 @@ class RouteRepr:
                 if not user_data:
                     user_data = "0u"
 
+                query = []
+                if m.group("query"):
+                    for arg in m.group("query").split("&"):
+                        key, argtype = arg.split(":")
+                        if key in (k for k, _ in query):
+                            l.warning(f"Duplicate query key {key}: {line}")
+                            continue
+                        query.append((key, argtype))
+                    if len(query) > QUERY_SCHEMA_MAX_KEYS:
+                        raise ValueError(f"Too many query keys: {line}")
+
                 return RouteRepr(
                     method=Method[m.group("method").upper()],
                     path=path,
@@ -132,6 +210,7 @@ class RouteRepr:
                     resp_handler=m.group("resp_handler") or "",
                     conditions=conditions,
                     user_data=user_data,
+                    query=query,
                 )
             else:
                 l.warning(f"Failed to parse route description: {line}")
@@ -201,6 +280,8 @@ class Tree:
         resph: str
         reqh: str
 
+        query: List[Tuple[str, str]] = field(default_factory=list)
+
         def unconditional(self) -> bool:
             return len(self.conditions) == 0
 
@@ -209,16 +290,53 @@ class Tree:
             
             c += self.get_conds_ifdef_clause(operator="&&")
 
-            c += f"\tLEAF(\"{self.name}\", {self.flags}, "
-
             resph = self.resph if self.resph else "NULL"
 
-            c += f"{self.reqh}, {resph}, {self.user_data}),"
+            if self.query:
+                c += f"\tLEAF_QUERY(\"{self.name}\", {self.flags}, "
+                c += f"{self.reqh}, {resph}, &{self._to_c_query_name()}, {self.user_data}),"
+            else:
+                c += f"\tLEAF(\"{self.name}\", {self.flags}, "
+                c += f"{self.reqh}, {resph}, {self.user_data}),"
 
             c += self.get_conds_endif_clause()
 
             return c
 
+        def _to_c_query_name(self) -> str:
+            name = "query_" + self.parent._to_c_array_name()
+            if self.name:
+                name += "_" + self.name.replace(":", "z").replace(".", "_")
+            method = Method(self.flags & METHOD_ALL)
+            return name + "_" + method.name.lower()
+
+        def toc_query_schema(self) -> str:
+            arg_types = {
+                "u": "ARG_UINT",
+                "x": "ARG_HEX",
+                "s": "ARG_STR",
+            }
+
+            keys = [k for k, _ in self.query]
+            bits, seed, table = gen_query_perfect_hash(keys)
+            name = self._to_c_query_name()
+
+            c = ""
+            c += self.get_conds_ifdef_clause(True, operator="&&")
+            c += f"static const struct query_schema_key {name}_keys[] = {{\n"
+            c += "\n".join([f"\tQUERY_KEY(\"{k}\", {arg_types[t]})," for k, t in self.query])
+            c += "\n};\n\n"
+            c += f"static const uint8_t {name}_table[] = {{\n\t"
+            c += ", ".join([f"{i}u" for i in table])
+            c += ",\n};\n\n"
+            c += f"static const struct query_schema {name} =\n"
+            c += f"\tQUERY_SCHEMA({name}_keys, {len(keys)}u,\n"
+            c += f"\t\t     {name}_table, {bits}u, 0x{seed:08x}u);"
+            c += self.get_conds_endif_clause(True)
+            c += "\n"
+
+            return c
+
         def __repr__(self) -> str:
             return f"[L] {self.flags} {self.name} -> {self.reqh}, {self.resph}" + " ! " + ", ".join(self.conditions)
 
@@ -229,6 +347,15 @@ class Tree:
         index: int = -1
         is_root: bool = False
 
+        # Sections with less static names have no lookup, 0 to disable
+        lookup_min_names: int = SECTION_LOOKUP_MIN_NAMES
+
+        # "hash" or "jump"
+        lookup: str = "hash"
+
+        # Name of the generated matcher, None if not generated
+        matcher: Optional[str] = None
+
         def add_condition(self, cond: str):
             if not self.unconditional():
                 self.conditions.add(cond)
@@ -258,6 +385,243 @@ class Tree:
                 if isinstance(child, Tree.Section) and child.name == name:
                     return child
 
+        def sort_children(self):
+            """
+            Sort static children by name (as memcmp(), children sharing a
+            name keep their relative order) and move typed children at the
+            end, as expected by the section lookup. Relative order of typed
+            children is kept.
+            """
+            static = [c for c in self.children if not c.flags & ARGS_MASK]
+            typed = [c for c in self.children if c.flags & ARGS_MASK]
+
+            self.children = sorted(static, key=lambda c: c.name.encode()) + typed
+
+            for child in self.children:
+                if isinstance(child, Tree.Section):
+                    child.sort_children()
+
+        def gen_lookup(self, min_names: int) -> Optional[Tuple]:
+            """
+            Lookup over static children names (unnamed leaves excluded).
+
+            Returns ("hash", bits, seed, table), table contains the position
+            of the first child with the name + 1, 0 if empty, or
+            ("jump", lo, table), children whose name starts with byte lo + i
+            are [table[i], table[i + 1]). A jump table is used if names can't
+            be hashed. None if the section is too small. Indexes are 8-bit,
+            ValueError is raised if the section has more than 255 children.
+            """
+            if min_names <= 0:
+                return None
+
+            names = list(dict.fromkeys(
+                c.name for c in self.children if not c.flags & ARGS_MASK and c.name))
+            if len(names) < min_names:
+                return None
+
+            if len(self.children) > 255:
+                raise ValueError(f"Section {self.name} has {len(self.children)} "
+                                 f"children, at most 255 can be indexed")
+
+            if self.lookup == "hash":
+                try:
+                    bits, seed, table = gen_query_perfect_hash(names)
+                except ValueError:
+                    l.warning(f"Section {self.name} children can't be hashed, "
+                              f"using a jump table: {names}")
+                else:
+                    first = [next(i for i, c in enumerate(self.children) if c.name == n)
+                             for n in names]
+                    table = [first[i - 1] + 1 if i else 0 for i in table]
+
+                    return "hash", bits, seed, table
+
+            bytes0 = [c.name.encode()[0] if c.name and not c.flags & ARGS_MASK else None
+                      for c in self.children]
+            typed = self._typed_position()
+            lo = min(b for b in bytes0 if b is not None)
+            hi = max(b for b in bytes0 if b is not None)
+            table = [next((i for i, b in enumerate(bytes0) if b is not None and b >= v), typed)
+                     for v in range(lo, hi + 2)]
+
+            return "jump", lo, table
+
+        def _typed_position(self) -> int:
+            return next((i for i, c in enumerate(self.children) if c.flags & ARGS_MASK),
+                        len(self.children))
+
+        def _to_c_lookup_name(self) -> str:
+            return self._to_c_array_name() + "_lookup"
+
+        def _to_c_index_exprs(self) -> Tuple[str, List[str]]:
+            """
+            C expressions of the position of each child (and of the end of the
+            array). If children are conditional, positions are computed by
+            the preprocessor with an enum.
+            """
+            n = len(self.children)
+            if all(c.get_conds_ifdef_clause() == "" for c in self.children):
+                return "", [f"{i}u" for i in range(n + 1)]
+
+            name = self._to_c_array_name()
+            c = "enum {\n"
+            c += f"\t{name}_i0 = 0,\n"
+            for i, child in enumerate(self.children):
+                cond = child.get_conds_ifdef_clause()
+                if cond:
+                    c += cond
+                    c += f"\t{name}_i{i + 1} = {name}_i{i} + 1,\n"
+                    c += "#else\n"
+                    c += f"\t{name}_i{i + 1} = {name}_i{i},\n"
+                    c += "#endif\n"
+                else:
+                    c += f"\t{name}_i{i + 1} = {name}_i{i} + 1,\n"
+            c += "};\n\n"
+
+            return c, [f"{name}_i{i}" for i in range(n + 1)]
+
+        def toc_lookup(self, min_names: int) -> str:
+            lookup = self.gen_lookup(min_names)
+            enum, index = self._to_c_index_exprs()
+            typed = index[self._typed_position()]
+            name = self._to_c_lookup_name()
+
+            if lookup[0] == "hash":
+                _, bits, seed, table = lookup
+                if enum:
+                    entries = [f"{index[i - 1]} + 1u" if i else "0u" for i in table]
+                else:
+                    entries = [f"{i}u" for i in table]
+                macro = f"ROUTE_HASH({name}_table, {bits}u, 0x{seed:08x}u, {typed})"
+            else:
+                _, lo, table = lookup
+                entries = [index[i] for i in table]
+                macro = f"ROUTE_JUMP({name}_table, 0x{lo:02x}u, {len(table) - 1}u, {typed})"
+
+            c = f"static const uint8_t {name}_table[] = {{\n\t"
+            c += ", ".join(entries)
+            c += ",\n};\n\n"
+            c += f"static const struct route_lookup {name} =\n"
+            c += f"\t{macro};"
+            c += "\n"
+
+            return c
+
+        def _to_c_match_name(self) -> str:
+            return f"{self.matcher}_{self._to_c_array_name()}"
+
+        def toc_match(self) -> str:
+            """
+            Matcher of the section: static children are selected with a
+            switch on the segment length (then on a discriminating byte) and
+            verified with memcmp(), typed children are parsed in order.
+            Same rules as route_tree_resolve_const().
+            """
+            _, index = self._to_c_index_exprs()
+            arr = self._to_c_array_name()
+
+            def ref(i: int) -> str:
+                return f"&{arr}[{index[i]}]"
+
+            exhaustive = False
+
+            def candidates(group: List[int], ind: str) -> str:
+                """Code matching the children, stops after a section"""
+                nonlocal exhaustive
+                exhaustive = False
+                c = ""
+                for i in group:
+                    child = self.children[i]
+                    cond = child.get_conds_ifdef_clause()
+                    number = child.flags & (ARGS_MASK & ~Flag.ARG_STR)
+                    parse = {
+                        Flag.ARG_UINT: "route_match_uint(m)",
+                        Flag.ARG_HEX: "route_match_hex(m)",
+                    }.get(number, f"route_match_number(m, {Flag(number)})" if number else None)
+
+                    c += cond
+                    if isinstance(child, Tree.Leaf):
+                        test = f"{parse} && " if parse else ""
+                        c += f"{ind}if ({test}route_match_flags(m, {ref(i)}))\n"
+                        c += f"{ind}\treturn route_match_leaf(m, {ref(i)});\n"
+                    elif parse:
+                        c += f"{ind}if ({parse}) {{\n"
+                        c += f"{ind}\troute_match_push(m, {ref(i)});\n"
+                        c += f"{ind}\treturn {child._to_c_match_name()}(m);\n"
+                        c += f"{ind}}}\n"
+                    else:
+                        c += f"{ind}route_match_push(m, {ref(i)});\n"
+                        c += f"{ind}return {child._to_c_match_name()}(m);\n"
+                    c += child.get_conds_endif_clause().lstrip("\n") + ("\n" if cond else "")
+
+                    # Section always matches, next children are unreachable
+                    if isinstance(child, Tree.Section) and not parse and not cond:
+                        exhaustive = True
+                        break
+                return c
+
+            def names_code(names: List[str], ind: str) -> str:
+                c = ""
+                for name in names:
+                    group = [i for i, ch in enumerate(self.children)
+                             if not ch.flags & ARGS_MASK and ch.name == name]
+                    if name:
+                        c += f"{ind}if (!memcmp(m->part.str, \"{name}\", {len(name)}u)) {{\n"
+                        c += candidates(group, ind + "\t")
+                        c += f"{ind}}}\n"
+                    else:
+                        c += candidates(group, ind)
+                return c
+
+            static = list(dict.fromkeys(
+                c.name for c in self.children if not c.flags & ARGS_MASK))
+            typed = [i for i, c in enumerate(self.children) if c.flags & ARGS_MASK]
+            unnamed = [i for i, c in enumerate(self.children)
+                       if isinstance(c, Tree.Leaf) and not c.flags & ARGS_MASK and not c.name]
+
+            c = self.get_conds_ifdef_clause(True, operator="||")
+            c += f"static const struct route_descr *{self._to_c_match_name()}(struct route_match *m)\n"
+            c += "{\n"
+            c += "\tif (!route_match_next(m)) {\n"
+            for i in unnamed:
+                child = self.children[i]
+                cond = child.get_conds_ifdef_clause()
+                c += cond
+                c += f"\t\tif (route_match_flags(m, {ref(i)}))\n"
+                c += f"\t\t\treturn route_match_unnamed(m, {ref(i)});\n"
+                c += child.get_conds_endif_clause().lstrip("\n") + ("\n" if cond else "")
+            c += "\t\treturn NULL;\n"
+            c += "\t}\n\n"
+
+            if static:
+                c += "\tswitch (m->part.len) {\n"
+                for n in sorted(set(len(name) for name in static)):
+                    names = [name for name in static if len(name) == n]
+                    c += f"\tcase {n}u:\n"
+                    if len(names) >= 3:
+                        # Byte with the most distinct values
+                        k = max(range(n), key=lambda k: (len(set(x[k] for x in names)), -k))
+                        c += f"\t\tswitch (m->part.str[{k}u]) {{\n"
+                        for b in dict.fromkeys(x[k] for x in names):
+                            c += f"\t\tcase '{b}':\n"
+                            c += names_code([x for x in names if x[k] == b], "\t\t\t")
+                            c += "\t\t\tbreak;\n"
+                        c += "\t\t}\n"
+                    else:
+                        c += names_code(names, "\t\t")
+                    c += "\t\tbreak;\n"
+                c += "\t}\n\n"
+
+            c += candidates(typed, "\t")
+            if not exhaustive:
+                c += ("\n" if typed else "") + "\treturn NULL;\n"
+            c += "}"
+            c += self.get_conds_endif_clause(True)
+            c += "\n"
+
+            return c
+
         def _to_c_array_name(self) -> str:
             if self.parent:
                 name = self.parent._to_c_array_name() + "_"
@@ -272,10 +636,16 @@ class Tree:
             c = ""
 
             c += self.get_conds_ifdef_clause(operator="&&")
-                
-            c += f"\tSECTION(\"{self.name}\", {self.flags}, " \
-                f"{self._to_c_array_name()}, \n\t\t"\
-                f"ARRAY_SIZE({self._to_c_array_name()}), {self.user_data}),"
+
+            if self.gen_lookup(self.lookup_min_names):
+                c += f"\tSECTION_LOOKUP(\"{self.name}\", {self.flags}, " \
+                    f"{self._to_c_array_name()}, \n\t\t"\
+                    f"ARRAY_SIZE({self._to_c_array_name()}), " \
+                    f"&{self._to_c_lookup_name()}, {self.user_data}),"
+            else:
+                c += f"\tSECTION(\"{self.name}\", {self.flags}, " \
+                    f"{self._to_c_array_name()}, \n\t\t"\
+                    f"ARRAY_SIZE({self._to_c_array_name()}), {self.user_data}),"
 
             c += self.get_conds_endif_clause()
 
@@ -283,11 +653,26 @@ class Tree:
 
         def toc_array(self) -> str:
             c = ""
+
+            for child in self.children:
+                if isinstance(child, Tree.Leaf) and child.query:
+                    c += child.toc_query_schema() + "\n"
+
             c += self.get_conds_ifdef_clause(True, operator="||")
             c += f"static const struct route_descr {self._to_c_array_name()}[] = {{\n"
 
             c += f"\n".join([child.toc() for child in self.children])
             c += "\n};"
+
+            lookup = self.gen_lookup(self.lookup_min_names)
+            if lookup or self.matcher:
+                enum, _ = self._to_c_index_exprs()
+                if enum:
+                    c += "\n\n" + enum.rstrip("\n")
+
+            if lookup:
+                c += "\n\n" + self.toc_lookup(self.lookup_min_names).rstrip("\n")
+
             c += self.get_conds_endif_clause(True)
 
             c += "\n"
@@ -330,7 +715,7 @@ class Tree:
                         part_name = ""
                         section = group_section
 
-                    flags = route.method | Flag.LEAF | part_name_to_arg_flags(part_name)                    
+                    flags = Flag(route.method) | Flag.LEAF | part_name_to_arg_flags(part_name)                    
                     section.add_part(
                         Tree.Leaf(
                             name=part_name,
@@ -340,6 +725,7 @@ class Tree:
                             conditions=set(route.conditions),
                             resph=route.resp_handler,
                             reqh=route.req_handler,
+                            query=route.query,
                         )
                     )
             else:
@@ -382,8 +768,17 @@ class Tree:
 
         _show(self.root, 0)
 
-    def generate_c(self) -> str:
+    def generate_c(self,
+                   lookup_min_names: int = SECTION_LOOKUP_MIN_NAMES,
+                   matcher: Optional[str] = None,
+                   lookup: str = "hash") -> str:
         def _generate_c(part: Tree.Section, arrays: List, sections: List[Tree.Section]):
+            for child in part.children:
+                if isinstance(child, Tree.Section):
+                    child.lookup_min_names = lookup_min_names
+                    child.lookup = lookup
+                    child.matcher = matcher
+
             array = part.toc_array()
             arrays.append(array)
 
@@ -395,6 +790,11 @@ class Tree:
 
                     _generate_c(child, arrays, sections)
 
+        self.root.sort_children()
+        self.root.lookup_min_names = lookup_min_names
+        self.root.lookup = lookup
+        self.root.matcher = matcher
+
         arrays = []
         sections = []
         _generate_c(self.root, arrays, sections)
@@ -405,6 +805,187 @@ class Tree:
 
         c += "\n".join(reversed(arrays)) + "\n"
 
+        # Root descriptor, gives its lookup to route_section_resolve_const()
+        c = c.rstrip("\n") + "\n\nstatic const struct route_descr root_section =\n"
+        if self.root.gen_lookup(lookup_min_names):
+            c += "\tSECTION_LOOKUP(\"\", 0u, root, ARRAY_SIZE(root), &root_lookup, 0u);\n"
+        else:
+            c += "\tSECTION(\"\", 0u, root, ARRAY_SIZE(root), 0u);\n"
+
+        if matcher:
+            c += "\n" + self.generate_c_matcher(matcher, [self.root] + sections)
+
+        return c
+
+    def generate_c_matcher(self, matcher: str, sections: List[Tree.Section]) -> str:
+        """
+        Drop-in replacement of route_tree_resolve_const() for this tree,
+        compiled if CONFIG_EMBEDC_URL_PARSER_MATCHER is defined.
+        """
+        c = "#if defined(CONFIG_EMBEDC_URL_PARSER_MATCHER)\n\n"
+        c += "\n".join(s.toc_match() for s in reversed(sections)) + "\n"
+        c += f"const struct route_descr *{matcher}(const char *url,\n"
+        c += f"\t\t\t\tsize_t len,\n"
+        c += f"\t\t\t\tuint32_t flags,\n"
+        c += f"\t\t\t\tuint32_t mask,\n"
+        c += f"\t\t\t\tstruct route_parse_result *results,\n"
+        c += f"\t\t\t\tsize_t *results_count,\n"
+        c += f"\t\t\t\tconst char **query_string)\n"
+        c += "{\n"
+        c += "\tstruct route_match m;\n\n"
+        c += "\tif (!results_count ||\n"
+        c += "\t    route_match_init(&m, url, len, flags, mask, results, *results_count))\n"
+        c += "\t\treturn NULL;\n\n"
+        c += f"\treturn route_match_finish(&m, {self.root._to_c_match_name()}(&m),\n"
+        c += "\t\t\t\t  results_count, query_string);\n"
+        c += "}\n\n"
+        c += "#endif /* CONFIG_EMBEDC_URL_PARSER_MATCHER */\n"
+
+        return c
+
+    def generate_c_packed(self, packed: str) -> str:
+        """
+        Same tree as a struct route_packed: a deduplicated names pool and
+        per node arrays, nodes in breadth-first order so that children of a
+        section are contiguous. Positions of conditional nodes are computed
+        by the preprocessor with an enum.
+        """
+        self.root.sort_children()
+
+        nodes: List[Tree.Part] = []
+        ranges = {}
+        queue = [self.root]
+        while queue:
+            section = queue.pop(0)
+            ranges[id(section)] = (len(nodes), len(nodes) + len(section.children))
+            for child in section.children:
+                nodes.append(child)
+                if isinstance(child, Tree.Section):
+                    queue.append(child)
+
+        def clause(c: str) -> str:
+            return c[len("#if "):].rstrip("\n")
+
+        def guard(part: Tree.Part) -> str:
+            # Clause of the node and of its array, up to the root
+            conds = []
+            while part.parent is not None:
+                own = part.get_conds_ifdef_clause(operator="&&")
+                if own:
+                    conds.append(clause(own))
+                if not part.parent.is_root:
+                    arr = part.parent.get_conds_ifdef_clause(True, operator="||")
+                    if arr:
+                        conds.append(clause(arr))
+                part = part.parent
+            conds = list(dict.fromkeys(conds))
+            if len(conds) == 1:
+                return conds[0]
+            return " && ".join(f"({c})" for c in conds)
+
+        guards = [guard(node) for node in nodes]
+        leaves = [i for i, node in enumerate(nodes) if isinstance(node, Tree.Leaf)]
+        conditional = any(guards)
+
+        # Positions of nodes and of leaves in the leaves table
+        enum = ""
+        if conditional:
+            enum = "enum {\n"
+            for prefix, items in (("p", range(len(nodes))), ("l", leaves)):
+                enum += f"\t{packed}_{prefix}0 = 0,\n"
+                for k, i in enumerate(items):
+                    cur, nxt = f"{packed}_{prefix}{k}", f"{packed}_{prefix}{k + 1}"
+                    if guards[i]:
+                        enum += f"#if {guards[i]}\n"
+                        enum += f"\t{nxt} = {cur} + 1,\n"
+                        enum += "#else\n"
+                        enum += f"\t{nxt} = {cur},\n"
+                        enum += "#endif\n"
+                    else:
+                        enum += f"\t{nxt} = {cur} + 1,\n"
+            enum += "};\n\n"
+            pos = [f"{packed}_p{k}" for k in range(len(nodes) + 1)]
+            lpos = {i: f"{packed}_l{k}" for k, i in enumerate(leaves)}
+        else:
+            pos = [f"{k}u" for k in range(len(nodes) + 1)]
+            lpos = {i: f"{k}u" for k, i in enumerate(leaves)}
+
+        # Names pool, names which are the suffix of a longer one share it
+        offsets = {}
+        pool = []
+        size = 0
+        for name in sorted(set(n.name for n in nodes), key=lambda n: (-len(n), n)):
+            for placed, off in pool:
+                if placed.endswith(name):
+                    offsets[name] = off + len(placed) - len(name)
+                    break
+            else:
+                pool.append((name, size))
+                offsets[name] = size
+                size += len(name) + 1
+
+        def array(ctype: str, suffix: str, entries: List[str]) -> str:
+            c = f"static const {ctype} {packed}_{suffix}[] = {{\n"
+            for i, entry in zip(range(len(nodes)), entries):
+                if guards[i]:
+                    c += f"#if {guards[i]}\n\t{entry},\n#endif\n"
+                else:
+                    c += f"\t{entry},\n"
+            c += "};\n\n"
+            return c
+
+        def section_range(node: Tree.Section) -> Tuple[str, str]:
+            begin, end = ranges[id(node)]
+            return pos[begin], pos[end]
+
+        c = ""
+        for node in nodes:
+            if isinstance(node, Tree.Leaf) and node.query:
+                c += node.toc_query_schema() + "\n"
+
+        c += enum
+        c += f"static const char {packed}_pool[] =\n"
+        c += "\n".join(f"\t\"{name}\\0\"" for name, _ in pool) if pool else "\t\"\""
+        c += ";\n\n"
+
+        c += array("uint16_t", "name", [f"{offsets[n.name]}u" for n in nodes])
+        c += array("uint8_t", "len", [f"{len(n.name)}u" for n in nodes])
+        c += array("uint16_t", "flags", [f"{n.flags} | IS_LEAF" if isinstance(n, Tree.Leaf)
+                                        else f"{n.flags}" for n in nodes])
+        c += array("uint16_t", "index", [lpos[i] if isinstance(n, Tree.Leaf)
+                                         else section_range(n)[0]
+                                         for i, n in enumerate(nodes)])
+        c += array("uint16_t", "count", ["0u" if isinstance(n, Tree.Leaf)
+                                         else "{1} - {0}".format(*section_range(n))
+                                         if conditional else
+                                         f"{ranges[id(n)][1] - ranges[id(n)][0]}u"
+                                         for n in nodes])
+
+        c += f"static const struct route_packed_leaf {packed}_leaves[] = {{\n"
+        for i in leaves:
+            leaf = nodes[i]
+            resph = leaf.resph if leaf.resph else "NULL"
+            query = f"&{leaf._to_c_query_name()}" if leaf.query else "NULL"
+            entry = f"\tROUTE_PACKED_LEAF({leaf.reqh}, {resph}, {query}, {leaf.user_data}),\n"
+            if guards[i]:
+                c += f"#if {guards[i]}\n{entry}#endif\n"
+            else:
+                c += entry
+        c += "};\n\n"
+
+        # User data of sections, leaves have theirs in the leaves table
+        user_data = "NULL"
+        if any(isinstance(n, Tree.Section) and n.user_data != "0u" for n in nodes):
+            c += array("uint32_t", "user_data", ["0u" if isinstance(n, Tree.Leaf)
+                                                 else n.user_data for n in nodes])
+            user_data = f"{packed}_user_data"
+
+        c += f"const struct route_packed {packed} =\n"
+        c += f"\tROUTE_PACKED({packed}_pool, {packed}_name, {packed}_len,\n"
+        c += f"\t\t     {packed}_flags, {packed}_index, {packed}_count,\n"
+        c += f"\t\t     {packed}_leaves, {user_data},\n"
+        c += f"\t\t     {section_range(self.root)[1]}, {pos[-1]});\n"
+
         return c
 
     def generate_c_handlers(self, extern: bool = True):
@@ -512,6 +1093,36 @@ if __name__ == "__main__":
                    action='store_true',
                    help='Ignore boundaries and parse whole file')
 
+    p.add_argument('--lookup',
+                   choices=['hash', 'jump'],
+                   default='hash',
+                   help='static children lookup of sections: perfect hash or '
+                        'first-byte jump table (sorted children)')
+    p.add_argument('--lookup-min',
+                   metavar='lookup_min',
+                   type=int,
+                   required=False,
+                   default=SECTION_LOOKUP_MIN_NAMES,
+                   help='minimum number of static children names for a section '
+                        'to get a lookup, 0 to disable')
+
+    p.add_argument('--matcher',
+                   metavar='matcher',
+                   type=str,
+                   required=False,
+                   default=None,
+                   help='also generate a matcher function with this name, '
+                        'compiled if CONFIG_EMBEDC_URL_PARSER_MATCHER is defined')
+
+    p.add_argument('--packed',
+                   metavar='packed',
+                   type=str,
+                   required=False,
+                   default=None,
+                   help='generate the tree as packed tables (struct route_packed) '
+                        'with this name instead of route descriptors, only '
+                        'route_packed_resolve() can use them')
+
     p.add_argument('-v', '--verbose',
                    action='store_true')
     p.add_argument('-gh', '--handlers',
@@ -531,7 +1142,10 @@ if __name__ == "__main__":
         True if args.descr_whole else False
     )
     tree = build_routes_tree(routes)
-    c_str = tree.generate_c()
+    if args.packed:
+        c_str = "\n" + tree.generate_c_packed(args.packed)
+    else:
+        c_str = tree.generate_c(args.lookup_min, args.matcher, args.lookup)
     generate_routes_def_file(args.output, c_str, args.def_begin, args.def_end)
 
     if args.verbose:
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#define ROUTE_BUILDER_ALIGN sizeof(void *)
+
+static void *route_builder_alloc(struct route_tree_builder *b, size_t size)
+{
+	const size_t start = (b->used + ROUTE_BUILDER_ALIGN - 1u) & ~(ROUTE_BUILDER_ALIGN - 1u);
+
+	if (start > b->size || size > b->size - start)
+		return NULL;
+
+	b->used = start + size;
+
+	return &b->buf[start];
+}
+
+/* Append count children, from list to last, to a section */
+static void route_builder_append(struct route_builder_node *s,
+				 struct route_builder_node *list,
+				 struct route_builder_node *last,
+				 size_t count)
+{
+	if (!list)
+		return;
+
+	if (s->last)
+		s->last->next = list;
+	else
+		s->children = list;
+
+	s->last = last;
+	s->child_count += count;
+}
+
+int route_tree_builder_init(struct route_tree_builder *builder,
+			    void *arena,
+			    size_t size)
+{
+	if (!builder || !arena || !size)
+		return -EINVAL;
+
+	builder->buf = arena;
+	builder->size = size;
+	builder->used = 0u;
+	builder->seq = 0u;
+
+	memset(&builder->root, 0, sizeof(builder->root));
+
+	return 0;
+}
+
+/* Flags of a typed part (e.g. "id:u", ":x64"), 0 if static */
+static uint32_t route_builder_arg_flags(const struct route_part *p)
+{
+	const char *const colon = memchr(p->str, ':', p->len);
+	if (!colon)
+		return 0u;
+
+	const char *const type = colon + 1u;
+	const size_t len = (size_t)(p->str + p->len - type);
+	uint32_t flags;
+
+	switch (len ? type[0] : '\0') {
+	case 's':
+		return (len == 1u) ? ROUTE_ARG_STR : 0u;
+	case 'u':
+		flags = ROUTE_ARG_UINT;
+		break;
+	case 'x':
+		flags = ROUTE_ARG_HEX;
+		break;
+	case 'i':
+		flags = ROUTE_ARG_INT;
+		break;
+	default:
+		return 0u;
+	}
+
+	if (len == 3u && type[1] == '6' && type[2] == '4')
+		return flags | ROUTE_ARG_64;
+
+	return (len == 1u) ? flags : 0u;
+}
+
+static int route_builder_name_cmp(const struct route_builder_node *a,
+				  const struct route_builder_node *b)
+{
+	const int r = memcmp(a->part.str, b->part.str, MIN(a->part.len, b->part.len));
+	if (r)
+		return r;
+
+	return (a->part.len > b->part.len) - (a->part.len < b->part.len);
+}
+
+static inline bool route_builder_is_leaf(const struct route_builder_node *n)
+{
+	return (n->flags & ROUTE_IS_LEAF_MASK) == ROUTE_IS_LEAF;
+}
+
+static inline bool route_builder_is_typed(const struct route_builder_node *n)
+{
+	return (n->flags & ROUTE_ARG_MASK) != 0u;
+}
+
+static int route_builder_method(const char *str, size_t len, uint32_t *method)
+{
+	static const struct {
+		const char *name;
+		uint32_t flag;
+	} methods[] = {
+		{"GET", ROUTE_GET},
+		{"POST", ROUTE_POST},
+		{"PUT", ROUTE_PUT},
+		{"DELETE", ROUTE_DELETE},
+	};
+
+	for (size_t i = 0u; i < ARRAY_SIZE(methods); i++) {
+		const char *const name = methods[i].name;
+
+		if (strlen(name) != len)
+			continue;
+
+		size_t k;
+		for (k = 0u; k < len && (str[k] & ~0x20) == name[k]; k++)
+			;
+
+		if (k == len) {
+			*method = methods[i].flag;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+int route_tree_builder_add(struct route_tree_builder *builder,
+			   const char *route,
+			   void (*resp_handler)(void),
+			   void (*req_handler)(void),
+			   uint32_t user_data)
+{
+	if (!builder || !route || !builder->buf)
+		return -EINVAL;
+
+	/* "METHOD /path" */
+	const char *const space = strchr(route, ' ');
+	uint32_t method;
+
+	if (!space || route_builder_method(route, (size_t)(space - route), &method))
+		return -EINVAL;
+
+	const char *path = space + 1u;
+	size_t len = strlen(path);
+
+	if (!len || path[0] != '/' || memchr(path, '?', len))
+		return -EINVAL;
+
+	while (len && path[0] == '/') {
+		path++;
+		len--;
+	}
+	while (len && path[len - 1u] == '/')
+		len--;
+
+	size_t count = 1u;
+	for (const char *c = path; (c = memchr(c, '/', len - (size_t)(c - path))); c++)
+		count++;
+
+	/* Names are kept NUL-terminated in the arena, nothing is linked
+	 * before everything is allocated
+	 */
+	const size_t used = builder->used;
+	char *const names = route_builder_alloc(builder, len + 1u);
+	struct route_builder_node *const nodes =
+		route_builder_alloc(builder, count * sizeof(struct route_builder_node));
+
+	if (!names || !nodes) {
+		builder->used = used;
+		return -ENOMEM;
+	}
+
+	memcpy(names, path, len);
+	names[len] = '\0';
+	memset(nodes, 0, count * sizeof(struct route_builder_node));
+
+	/* Chain of sections ending with the leaf, merged with the other
+	 * routes by route_tree_builder_finish()
+	 */
+	size_t pos = 0u;
+	for (size_t i = 0u; i < count; i++) {
+		struct route_builder_node *const n = &nodes[i];
+		const char *const slash = memchr(&names[pos], '/', len - pos);
+		const size_t end = slash ? (size_t)(slash - names) : len;
+
+		names[end] = '\0';
+		n->part.str = &names[pos];
+		n->part.len = end - pos;
+		n->flags = route_builder_arg_flags(&n->part);
+		n->user_data = user_data;
+		n->seq = builder->seq;
+
+		if (i + 1u < count) {
+			n->children = n->last = &nodes[i + 1u];
+			n->child_count = 1u;
+		} else {
+			n->flags |= method | ROUTE_IS_LEAF;
+			n->resp_handler = resp_handler;
+			n->req_handler = req_handler;
+		}
+
+		pos = end + 1u;
+	}
+
+	route_builder_append(&builder->root, nodes, nodes, 1u);
+	builder->seq++;
+
+	return 0;
+}
+
+/* Static children by name, then typed children by name, in order of
+ * registration for a same name
+ */
+static int route_builder_cmp_name(const struct route_builder_node *a,
+				  const struct route_builder_node *b)
+{
+	const bool ta = route_builder_is_typed(a);
+	const bool tb = route_builder_is_typed(b);
+
+	if (ta != tb)
+		return (int)ta - (int)tb;
+
+	const int r = route_builder_name_cmp(a, b);
+	if (r)
+		return r;
+
+	return (a->seq > b->seq) - (a->seq < b->seq);
+}
+
+/* Static children kept in order, then typed children by registration */
+static int route_builder_cmp_order(const struct route_builder_node *a,
+				   const struct route_builder_node *b)
+{
+	const bool ta = route_builder_is_typed(a);
+	const bool tb = route_builder_is_typed(b);
+
+	if (ta != tb)
+		return (int)ta - (int)tb;
+
+	if (!ta)
+		return 0;
+
+	return (a->seq > b->seq) - (a->seq < b->seq);
+}
+
+/* Stable merge sort of a children list */
+static struct route_builder_node *route_builder_sort(struct route_builder_node *list,
+						     size_t count,
+						     int (*cmp)(const struct route_builder_node *,
+								const struct route_builder_node *))
+{
+	if (count < 2u)
+		return list;
+
+	struct route_builder_node *mid = list;
+	for (size_t i = 1u; i < count / 2u; i++)
+		mid = mid->next;
+
+	struct route_builder_node *right = mid->next;
+	mid->next = NULL;
+
+	struct route_builder_node *left = route_builder_sort(list, count / 2u, cmp);
+	right = route_builder_sort(right, count - count / 2u, cmp);
+
+	struct route_builder_node *head = NULL;
+	struct route_builder_node **tail = &head;
+
+	while (left && right) {
+		struct route_builder_node **const src =
+			(cmp(right, left) < 0) ? &right : &left;
+
+		*tail = *src;
+		tail = &(*src)->next;
+		*src = (*src)->next;
+	}
+
+	*tail = left ? left : right;
+
+	return head;
+}
+
+/* Merge the children of a section sharing a name, then its subsections:
+ * - sections are merged into the first one registered,
+ * - leaves named as a section become its unnamed leaves,
+ * - a leaf whose methods are already routed is dropped, the first one
+ *   registered is kept,
+ * - typed children are ordered by first registration of their name.
+ */
+static void route_builder_merge(struct route_builder_node *s)
+{
+	struct route_builder_node *head = NULL;
+	struct route_builder_node **tail = &head;
+	size_t count = 0u;
+
+	struct route_builder_node *n =
+		route_builder_sort(s->children, s->child_count, route_builder_cmp_name);
+
+	while (n) {
+		/* Children [n, end) share a name, in order of registration */
+		struct route_builder_node *section = NULL;
+		struct route_builder_node *end = n;
+
+		for (; end && !route_builder_name_cmp(end, n); end = end->next) {
+			if (!section && !route_builder_is_leaf(end))
+				section = end;
+		}
+
+		const uint32_t first = n->seq;
+		uint32_t methods = 0u;
+
+		while (n != end) {
+			struct route_builder_node *const g = n;
+
+			n = n->next;
+			g->next = NULL;
+
+			if (section && g != section) {
+				if (route_builder_is_leaf(g)) {
+					g->part.str = "";
+					g->part.len = 0u;
+					/* Argument is parsed by the section */
+					g->flags &= ~(ROUTE_ARG_MASK | ROUTE_ARG_64);
+					route_builder_append(section, g, g, 1u);
+				} else {
+					route_builder_append(section, g->children, g->last,
+							     g->child_count);
+				}
+				continue;
+			}
+
+			if (!section) {
+				if (g->flags & methods)
+					continue;
+
+				methods |= g->flags & ROUTE_METHODS_MASK;
+			}
+
+			g->seq = first;
+			*tail = g;
+			tail = &g->next;
+			count++;
+		}
+	}
+
+	s->children = route_builder_sort(head, count, route_builder_cmp_order);
+	s->child_count = count;
+	s->last = NULL;
+
+	/* Merged tree stays a valid builder tree, routes can still be added
+	 * to it if it can't be emitted
+	 */
+	for (n = s->children; n; n = n->next) {
+		if (!route_builder_is_leaf(n))
+			route_builder_merge(n);
+
+		s->last = n;
+	}
+}
+
+/* Arena space taken by the descriptors of a merged section */
+static size_t route_builder_emit_size(const struct route_builder_node *s)
+{
+	const size_t bytes = s->child_count * sizeof(struct route_descr);
+	size_t size = (bytes + ROUTE_BUILDER_ALIGN - 1u) & ~(ROUTE_BUILDER_ALIGN - 1u);
+
+	for (const struct route_builder_node *n = s->children; n; n = n->next) {
+		if (!route_builder_is_leaf(n))
+			size += route_builder_emit_size(n);
+	}
+
+	return size;
+}
+
+/* Space is checked before, allocations can't fail */
+static void route_builder_emit(struct route_tree_builder *b,
+			       struct route_builder_node *section,
+			       struct route_descr **list)
+{
+	struct route_descr *const descrs =
+		route_builder_alloc(b, section->child_count * sizeof(struct route_descr));
+
+	size_t i = 0u;
+	for (struct route_builder_node *n = section->children; n; n = n->next, i++) {
+		struct route_descr *const d = &descrs[i];
+
+		memset(d, 0, sizeof(*d));
+		d->flags = n->flags;
+		d->part = n->part;
+		d->user_data = n->user_data;
+
+		if (route_builder_is_leaf(n)) {
+			d->resp_handler = n->resp_handler;
+			d->req_handler = n->req_handler;
+		} else {
+			struct route_descr *children;
+
+			route_builder_emit(b, n, &children);
+
+			d->children.list = children;
+			d->children.count = n->child_count;
+		}
+	}
+
+	*list = descrs;
+}
+
+int route_tree_builder_finish(struct route_tree_builder *builder,
+			      const struct route_descr **root,
+			      size_t *size)
+{
+	struct route_descr *list;
+
+	if (!builder || !root || !size || !builder->buf)
+		return -EINVAL;
+
+	if (!builder->root.child_count)
+		return -ENOENT;
+
+	route_builder_merge(&builder->root);
+
+	const size_t start = (builder->used + ROUTE_BUILDER_ALIGN - 1u) &
+			     ~(ROUTE_BUILDER_ALIGN - 1u);
+
+	if (start > builder->size ||
+	    route_builder_emit_size(&builder->root) > builder->size - start)
+		return -ENOMEM;
+
+	route_builder_emit(builder, &builder->root, &list);
+
+	*root = list;
+	*size = builder->root.child_count;
+
+	/* Nodes now belong to the tree */
+	builder->buf = NULL;
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _EMBEDC_URL_CLASSIFY_H_
+#define _EMBEDC_URL_CLASSIFY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Delimiters classification, CLASSIFY_BLOCK bytes at a time.
+ *
+ * classify_block() returns a mask where the bit of byte i (at position
+ * i << CLASSIFY_SHIFT) is set if the byte is equal to one of the three
+ * given characters. CLASSIFY_BLOCK bytes must be readable at p.
+ *
+ * classify_next() returns the index of the first delimiter of the mask
+ * and clears it, the mask must not be zero.
+ */
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define CLASSIFY_BLOCK 32u
+#define CLASSIFY_SHIFT 0u
+
+typedef uint32_t classify_mask_t;
+
+static inline classify_mask_t classify_block(const char *p, char a, char b, char c)
+{
+	const __m256i v = _mm256_loadu_si256((const __m256i *)p);
+	const __m256i m = _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(a)),
+				_mm256_cmpeq_epi8(v, _mm256_set1_epi8(b))),
+		_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+
+	return (classify_mask_t)_mm256_movemask_epi8(m);
+}
+
+#define CLASSIFY_CTZ(m) __builtin_ctz(m)
+
+#elif defined(__SSE2__)
+
+#include <emmintrin.h>
+
+#define CLASSIFY_BLOCK 16u
+#define CLASSIFY_SHIFT 0u
+
+typedef uint32_t classify_mask_t;
+
+static inline classify_mask_t classify_block(const char *p, char a, char b, char c)
+{
+	const __m128i v = _mm_loadu_si128((const __m128i *)p);
+	const __m128i m = _mm_or_si128(
+		_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(a)),
+			     _mm_cmpeq_epi8(v, _mm_set1_epi8(b))),
+		_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+
+	return (classify_mask_t)_mm_movemask_epi8(m);
+}
+
+#define CLASSIFY_CTZ(m) __builtin_ctz(m)
+
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+/* SWAR: a machine word is processed as a vector of bytes,
+ * the most significant bit of each byte is set for exact matches.
+ */
+#define CLASSIFY_BLOCK sizeof(unsigned long)
+#define CLASSIFY_SHIFT 3u
+
+typedef unsigned long classify_mask_t;
+
+#define SWAR_ONES (~0ul / 0xffu)
+#define SWAR_LOW7 (SWAR_ONES * 0x7fu)
+
+static inline classify_mask_t swar_eq(classify_mask_t w, char c)
+{
+	const classify_mask_t t = w ^ (SWAR_ONES * (unsigned char)c);
+
+	return ~(((t & SWAR_LOW7) + SWAR_LOW7) | t | SWAR_LOW7);
+}
+
+static inline classify_mask_t classify_block(const char *p, char a, char b, char c)
+{
+	classify_mask_t w;
+	memcpy(&w, p, sizeof(w));
+
+	return swar_eq(w, a) | swar_eq(w, b) | swar_eq(w, c);
+}
+
+#define CLASSIFY_CTZ(m) __builtin_ctzl(m)
+
+#else
+
+#define CLASSIFY_BLOCK 8u
+#define CLASSIFY_SHIFT 0u
+
+typedef uint32_t classify_mask_t;
+
+static inline classify_mask_t classify_block(const char *p, char a, char b, char c)
+{
+	classify_mask_t m = 0u;
+
+	for (size_t i = 0u; i < CLASSIFY_BLOCK; i++) {
+		if (p[i] == a || p[i] == b || p[i] == c)
+			m |= 1u << i;
+	}
+
+	return m;
+}
+
+/* No compiler builtin assumed here, the mask holds at most 8 bits */
+static inline unsigned int classify_ctz(classify_mask_t m)
+{
+	unsigned int n = 0u;
+
+	while ((m & 1u) == 0u) {
+		m >>= 1u;
+		n++;
+	}
+
+	return n;
+}
+
+#define CLASSIFY_CTZ(m) classify_ctz(m)
+
+#endif
+
+static inline size_t classify_next(classify_mask_t *m)
+{
+	const size_t i = (size_t)CLASSIFY_CTZ(*m) >> CLASSIFY_SHIFT;
+
+	*m &= *m - 1u;
+
+	return i;
+}
+
+#endif /* _EMBEDC_URL_CLASSIFY_H_ */
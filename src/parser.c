@@ -7,93 +7,233 @@
 
 #include <errno.h>
 #include <string.h>
-#include <stdio.h>
 
 #include <embedc-url/parser.h>
 #include <embedc-url/parser_internal.h>
 
+#include "classify.h"
+
 #ifndef CONFIG_EMBEDC_URL_PARSER_ITER_MAX_DEPTH
 #define CONFIG_EMBEDC_URL_PARSER_ITER_MAX_DEPTH 10u
 #endif /* CONFIG_EMBEDC_URL_PARSER_ITER_MAX_DEPTH */
 
+#ifndef CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS
+#define CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS 16u
+#endif /* CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS */
+
+#ifndef CONFIG_EMBEDC_URL_PARSER_BACKTRACK_MEMO
+#define CONFIG_EMBEDC_URL_PARSER_BACKTRACK_MEMO 4u
+#endif /* CONFIG_EMBEDC_URL_PARSER_BACKTRACK_MEMO */
+
+#ifndef CONFIG_EMBEDC_URL_PARSER_BATCH_WIDTH
+#define CONFIG_EMBEDC_URL_PARSER_BATCH_WIDTH 8u
+#endif /* CONFIG_EMBEDC_URL_PARSER_BATCH_WIDTH */
+
+#if defined(__GNUC__)
+#define ROUTE_PREFETCH(_p) __builtin_prefetch(_p)
+#else
+#define ROUTE_PREFETCH(_p) ((void)(_p))
+#endif
+
+#ifndef CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_ARGS
+#define CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_ARGS 128u
+#endif /* CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_ARGS */
+
+#ifndef CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_KEY_LEN
+#define CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_KEY_LEN 64u
+#endif /* CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_KEY_LEN */
+
+struct query_parse_state {
+	struct query_arg *qargs;
+	size_t alen;
+
+	/* Number of complete arguments */
+	size_t count;
+
+	/* Argument being parsed */
+	struct query_arg *arg;
+
+	/* Temporary query argument.
+	 * To keep track of current state if qargs is not long enough */
+	struct query_arg zarg;
+};
+
+static inline void query_parse_delim(struct query_parse_state *st, char *chr)
+{
+	switch (*chr) {
+	case '?':
+		/* Reset parsing */
+		if (st->count) {
+			st->arg = st->alen ? &st->qargs[0u] : &st->zarg;
+			st->count = 0u;
+		}
+
+		*chr = '\0';
+		st->arg->key = chr + 1u;
+		st->arg->value = NULL;
+		st->arg->decoded = false;
+		break;
+	case '&':
+		*chr = '\0';
+		/* If previous argument is not valid, ignore it */
+		if (*st->arg->key != '\0') {
+			st->count++;
+			st->arg = (st->count < st->alen) ? &st->qargs[st->count] : &st->zarg;
+		}
+		st->arg->key = chr + 1u;
+		st->arg->value = NULL; /* In case no value is found */
+		st->arg->decoded = false;
+		break;
+	case '=':
+		/* Key ends at the first '=', later ones belong to the value */
+		if (st->arg->value)
+			break;
+
+		*chr = '\0';
+		st->arg->value = chr + 1u;
+		st->arg->decoded = false;
+		break;
+	default:
+		break;
+	}
+}
+
 int query_args_parse(char *url, struct query_arg qargs[], size_t alen)
 {
 	if (!url || (!qargs && alen))
 		return -EINVAL;
 
-	size_t count = 0u;
+	struct query_parse_state st = {
+		.qargs = qargs,
+		.alen = alen,
+		.count = 0u,
+	};
 
-	/* Temporary query argument.
-	 * To keep track of current state if qargs is not long enough */
-	struct query_arg zarg;
-	struct query_arg *arg = &qargs[0u];
-	arg->key = url;
-	arg->value = NULL;
+	st.arg = alen ? &qargs[0u] : &st.zarg;
+	st.arg->key = url;
+	st.arg->value = NULL;
+	st.arg->decoded = false;
 
-	char *chr = url;
+	const size_t len = strlen(url);
+	size_t off = 0u;
 
-	do {
-		switch (*chr) {
-		case '?':
-			/* Reset parsing */
-			if (count) {
-				arg = &qargs[0u];
-				arg->value = NULL;
-				count = 0u;
-			}
+	/* Classify whole blocks, then only visit the delimiters */
+	for (; off + CLASSIFY_BLOCK <= len; off += CLASSIFY_BLOCK) {
+		classify_mask_t m = classify_block(&url[off], '?', '&', '=');
 
-			*chr = '\0';
-			arg->key = chr + 1u;
-			break;
-		case '&':
-			*chr = '\0';
-			/* If previous argument is not valid, ignore it */
-			if (!arg || *arg->key != '\0') {
-				count++;
-				arg = (count < alen) ? &qargs[count] : &zarg;
-				arg->value = NULL; /* In case no value is found */
-			}
-			arg->key = chr + 1u;
-			break;
-		case '=':
-			*chr = '\0';
-			if (arg) {
-				arg->value = chr + 1u;
-			}
-			break;
-		default:
-			break;
+		while (m) {
+			query_parse_delim(&st, &url[off + classify_next(&m)]);
 		}
+	}
 
-		chr++;
-	} while (*chr != '\0');
+	for (; off < len; off++) {
+		query_parse_delim(&st, &url[off]);
+	}
 
 	/* If last argument is not empty, add it */
-	if (arg && *arg->key != '\0') {
-		count++;
+	if (*st.arg->key != '\0') {
+		st.count++;
+	}
+
+	return (int)st.count;
+}
+
+int query_args_count(const char *url)
+{
+	if (!url)
+		return -EINVAL;
+
+	/* Arguments are only parsed after the last '?' */
+	const char *p = strrchr(url, '?');
+	p = p ? p + 1u : url;
+
+	size_t count = 0u;
+
+	for (;;) {
+		/* Arguments with an empty key are ignored */
+		if (*p != '\0' && *p != '&' && *p != '=')
+			count++;
+
+		p = strchr(p, '&');
+		if (!p)
+			break;
+		p++;
 	}
 
 	return (int)count;
 }
 
-/* TODO improve this: don't directly use query_args_parse
- * but try to parse the string with the same method
- * but trying to find the key
- */
+int query_args_parse_arena(char *url, struct query_arena *arena)
+{
+	if (!url || !arena)
+		return -EINVAL;
+
+	const int count = query_args_count(url);
+
+	if ((size_t)count > arena->alen) {
+		if (!arena->grow || arena->grow(arena, (size_t)count) ||
+		    arena->alen < (size_t)count)
+			return -ENOMEM;
+	}
+
+	return query_args_parse(url, arena->qargs, arena->alen);
+}
+
 char *query_args_parse_find(char *url, const char *key)
 {
-	struct query_arg qargs[10u];
-	char *value = NULL;
+	if (!url || !key || *key == '\0')
+		return NULL;
+
+	/* Arguments are only parsed after the last '?' */
+	char *chr = strrchr(url, '?');
+	if (chr) {
+		*chr++ = '\0';
+	} else {
+		chr = url;
+	}
+
+	for (;;) {
+		/* Compare key while tokenizing it, kp is NULL on mismatch */
+		const char *kp = key;
+		while (*chr != '\0' && *chr != '&' && *chr != '=') {
+			kp = (kp && *kp == *chr) ? kp + 1u : NULL;
+			chr++;
+		}
+
+		const bool match = kp && *kp == '\0';
+		char *value = NULL;
+
+		/* Value starts after the first '=' of the argument */
+		if (*chr == '=') {
+			if (match) {
+				*chr = '\0';
+			}
+			value = ++chr;
+			while (*chr != '\0' && *chr != '&')
+				chr++;
+		}
+
+		if (match) {
+			*chr = '\0';
+			if (value) {
+				const size_t vlen = chr - value;
+				query_value_decode(value, vlen, value, vlen + 1u);
+			}
+			return value;
+		}
+
+		if (*chr == '\0')
+			break;
 
-	int count = query_args_parse(url, qargs, ARRAY_SIZE(qargs));
-	if (count > 0) {
-		value = query_arg_get(qargs, MIN(count, (int)ARRAY_SIZE(qargs)), key);
+		chr++; /* Skip '&' */
 	}
 
-	return value;
+	return NULL;
 }
 
-char *query_arg_get(struct query_arg qargs[], size_t alen, const char *key)
+static struct query_arg *query_arg_find(struct query_arg qargs[],
+					size_t alen,
+					const char *key)
 {
 	if (!qargs || !key)
 		return NULL;
@@ -101,341 +241,2848 @@ char *query_arg_get(struct query_arg qargs[], size_t alen, const char *key)
 	for (size_t i = 0u; i < alen; i++) {
 		struct query_arg *const arg = &qargs[i];
 		if (arg->key && strcmp(arg->key, key) == 0) {
-			return arg->value;
+			return arg;
 		}
 	}
 
 	return NULL;
 }
 
+/* Decode the value in place, only once */
+static struct query_arg *query_arg_decode(struct query_arg *arg)
+{
+	if (arg && arg->value && !arg->decoded) {
+		const size_t len = strlen(arg->value);
+		query_value_decode(arg->value, len, arg->value, len + 1u);
+		arg->decoded = true;
+	}
 
-int route_parse(char *url,
-		route_parser_cb_t cb,
-		void *user_data)
+	return arg;
+}
+
+char *query_arg_get(struct query_arg qargs[], size_t alen, const char *key)
 {
-	if (!url || !cb)
-		return -EINVAL;
+	struct query_arg *const arg = query_arg_decode(query_arg_find(qargs, alen, key));
 
-	char *p = url;
+	return arg ? arg->value : NULL;
+}
 
-	int ret = 0;
-	bool zcontinue = true;
-	struct route_part s;
+struct query_arg *query_arg_next(struct query_arg qargs[],
+				 size_t alen,
+				 const char *key,
+				 size_t *cursor)
+{
+	if (!cursor || *cursor >= alen)
+		return NULL;
 
-	/* Remove leading '/' */
-	while (*p == '/')
-		p++;
+	struct query_arg *const arg =
+		query_arg_find(&qargs[*cursor], alen - *cursor, key);
 
-	s.str = p;
-	s.len = 0u;
+	*cursor = arg ? (size_t)(arg - qargs) + 1u : alen;
 
-	while (zcontinue) {
-		switch (*p) {
+	return query_arg_decode(arg);
+}
 
-		case '?':
-		case '\0':
-			zcontinue = false;
-		case '/':
-			*p = '\0'; /* Slice the route */
-			zcontinue &= (ret = cb(&s, user_data)) == 0;
-			s.str = p + 1u;
-			s.len = 0u;
-			break;
-		default:
-			s.len++;
-			break;
-		}
-		p++;
+struct query_span_state {
+	struct query_arg_span *spans;
+	size_t alen;
+
+	/* Number of complete arguments */
+	size_t count;
+
+	/* Argument being parsed */
+	struct query_arg_span *arg;
+
+	/* Temporary argument, if spans is not long enough */
+	struct query_arg_span zarg;
+
+	/* Whether key/value of current argument are still being scanned */
+	bool key_open;
+	bool value_open;
+};
+
+static inline void query_span_close(struct query_span_state *st, size_t pos)
+{
+	if (st->key_open) {
+		st->arg->key.len = pos - st->arg->key.offset;
+		st->key_open = false;
 	}
 
-	/* Return number of chars parsed */
-	return ret ? ret : p - url;
+	if (st->value_open) {
+		st->arg->value.len = pos - st->arg->value.offset;
+		st->value_open = false;
+	}
 }
 
-static inline bool is_leaf(const struct route_descr *descr)
+/* Same state machine as query_parse_delim(), but delimiters are not
+ * overwritten, they terminate the key and value being scanned instead.
+ */
+static inline void query_span_delim(struct query_span_state *st, char c, size_t pos)
 {
-	return (descr->flags & ROUTE_IS_LEAF_MASK) == ROUTE_IS_LEAF;
+	if (c != '?' && c != '&' && c != '=')
+		return;
+
+	/* Key ends at the first '=', later ones belong to the value */
+	if (c == '=' && st->value_open)
+		return;
+
+	query_span_close(st, pos);
+
+	switch (c) {
+	case '?':
+		/* Reset parsing */
+		if (st->count) {
+			st->arg = st->alen ? &st->spans[0u] : &st->zarg;
+			st->count = 0u;
+		}
+
+		st->arg->key.offset = pos + 1u;
+		st->arg->value.offset = 0u;
+		st->arg->value.len = 0u;
+		st->key_open = true;
+		break;
+	case '&':
+		/* If previous argument is not valid, ignore it */
+		if (st->arg->key.len != 0u) {
+			st->count++;
+			st->arg = (st->count < st->alen) ? &st->spans[st->count] : &st->zarg;
+		}
+
+		st->arg->key.offset = pos + 1u;
+		st->arg->value.offset = 0u; /* In case no value is found */
+		st->arg->value.len = 0u;
+		st->key_open = true;
+		break;
+	case '=':
+		st->arg->value.offset = pos + 1u;
+		st->value_open = true;
+		break;
+	default:
+		break;
+	}
 }
 
-int route_tree_iterate(const struct route_descr *root,
-		       size_t size,
-		       route_tree_iter_cb_t cb,
-		       void *user_data)
+int query_args_parse_spans(const char *url,
+			   size_t len,
+			   struct query_arg_span spans[],
+			   size_t alen)
 {
-	if (!root || !size || !cb)
+	if (!url || (!spans && alen))
 		return -EINVAL;
 
-	const struct route_descr *parents[CONFIG_EMBEDC_URL_PARSER_ITER_MAX_DEPTH];
-	size_t depth = 0u;
-	size_t routes_count = 0u;
+	struct query_span_state st = {
+		.spans = spans,
+		.alen = alen,
+		.count = 0u,
+		.key_open = true,
+		.value_open = false,
+	};
 
-	const struct route_descr *first = root;
-	const struct route_descr *node = first;
-	size_t children_count = size;
+	st.arg = alen ? &spans[0u] : &st.zarg;
+	st.arg->key.offset = 0u;
+	st.arg->value.offset = 0u;
+	st.arg->value.len = 0u;
 
-	while (node) {
-		if (cb(node, parents, depth, user_data) == false)
-			goto exit;
+	size_t off = 0u;
 
-		if (is_leaf(node)) {
-			routes_count++;
+	for (; off + CLASSIFY_BLOCK <= len; off += CLASSIFY_BLOCK) {
+		classify_mask_t m = classify_block(&url[off], '?', '&', '=');
 
-			const size_t index = node - first;
-			if (index < children_count - 1u) {
-				node++;
-				continue;
+		while (m) {
+			const size_t pos = off + classify_next(&m);
+			query_span_delim(&st, url[pos], pos);
+		}
+	}
+
+	for (; off < len; off++) {
+		query_span_delim(&st, url[off], off);
+	}
+
+	query_span_close(&st, len);
+
+	/* If last argument is not empty, add it */
+	if (st.arg->key.len != 0u) {
+		st.count++;
+	}
+
+	return (int)st.count;
+}
+
+const struct query_arg_span *query_arg_span_get(const char *url,
+						const struct query_arg_span spans[],
+						size_t alen,
+						const char *key)
+{
+	if (!url || !spans || !key)
+		return NULL;
+
+	const size_t klen = strlen(key);
+
+	for (size_t i = 0u; i < alen; i++) {
+		const struct query_arg_span *const arg = &spans[i];
+		if (arg->key.len == klen &&
+		    memcmp(&url[arg->key.offset], key, klen) == 0) {
+			return arg;
+		}
+	}
+
+	return NULL;
+}
+
+int query_args_parse_next(const char *url,
+			  size_t len,
+			  const char *key,
+			  size_t *cursor,
+			  struct query_arg_span *arg)
+{
+	if (!url || !key || !cursor || !arg)
+		return -EINVAL;
+
+	size_t i = *cursor;
+
+	/* First call: arguments are only parsed after the last '?' */
+	if (i == 0u) {
+		for (size_t j = len; j > 0u; j--) {
+			if (url[j - 1u] == '?') {
+				i = j;
+				break;
 			}
+		}
+	}
 
-			do {
-				if (depth == 0u)
-					goto exit;
+	while (i < len) {
+		/* Compare key while tokenizing it, kp is NULL on mismatch */
+		const size_t start = i;
+		const char *kp = key;
+		while (i < len && url[i] != '&' && url[i] != '=') {
+			kp = (kp && *kp == url[i]) ? kp + 1u : NULL;
+			i++;
+		}
 
-				node = parents[--depth] + 1u;
-				if (depth == 0) {
-					first = root;
-					children_count = size;
-				} else {
-					first = parents[depth - 1u]->children.list;
-					children_count = parents[depth - 1u]->children.count;
-				}
-			} while (node - first >= (int)children_count);
+		const bool match = kp && *kp == '\0' && i > start;
+
+		arg->key.offset = start;
+		arg->key.len = i - start;
+		arg->value.offset = 0u;
+		arg->value.len = 0u;
+
+		/* Value starts after the first '=' of the argument */
+		if (i < len && url[i] == '=') {
+			arg->value.offset = ++i;
+			while (i < len && url[i] != '&')
+				i++;
+			arg->value.len = i - arg->value.offset;
+		}
+
+		i++; /* Skip '&' */
+
+		if (match) {
+			*cursor = i;
+			return 0;
+		}
+	}
+
+	*cursor = len + 1u;
+
+	return -ENOENT;
+}
+
+char *query_span_copy(const char *url,
+		      const struct query_span *span,
+		      char *buf,
+		      size_t size)
+{
+	if (!url || !span || !buf || span->len >= size)
+		return NULL;
+
+	memcpy(buf, &url[span->offset], span->len);
+	buf[span->len] = '\0';
+
+	return buf;
+}
+
+
+static inline int hex_digit(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	c |= 0x20; /* lower case */
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+/* Return index of the first '%' or '+' from src[i], len if none */
+static size_t query_decode_run(const char *src, size_t i, size_t len)
+{
+	for (; i + CLASSIFY_BLOCK <= len; i += CLASSIFY_BLOCK) {
+		classify_mask_t m = classify_block(&src[i], '%', '+', '%');
+		if (m)
+			return i + classify_next(&m);
+	}
+
+	while (i < len && src[i] != '%' && src[i] != '+')
+		i++;
+
+	return i;
+}
+
+int query_value_decode(const char *src, size_t len, char *dst, size_t size)
+{
+	if (!src || !dst || !size)
+		return -EINVAL;
+
+	size_t i = 0u;
+	size_t o = 0u;
+
+	while (i < len) {
+		/* Copy run without escapes at once */
+		const size_t run = query_decode_run(src, i, len);
+		if (o + (run - i) >= size)
+			return -ENOMEM;
+
+		if (&dst[o] != &src[i])
+			memmove(&dst[o], &src[i], run - i);
+		o += run - i;
+		i = run;
+
+		if (i == len)
+			break;
+
+		if (o + 1u >= size)
+			return -ENOMEM;
+
+		if (src[i] == '+') {
+			dst[o++] = ' ';
+			i++;
 		} else {
-			if (depth >= CONFIG_EMBEDC_URL_PARSER_ITER_MAX_DEPTH)
-				return -EOVERFLOW;
+			const int hi = (i + 2u < len) ? hex_digit(src[i + 1u]) : -1;
+			const int lo = (hi >= 0) ? hex_digit(src[i + 2u]) : -1;
 
-			parents[depth++] = node;
-			children_count = node->children.count;
-			first = node->children.list;
-			node = first;
+			if (lo >= 0) {
+				dst[o++] = (char)((hi << 4) | lo);
+				i += 3u;
+			} else {
+				/* Invalid escape sequence, keep it as is */
+				dst[o++] = '%';
+				i++;
+			}
 		}
 	}
 
-exit:
-	return routes_count;
+	dst[o] = '\0';
+
+	return (int)o;
 }
 
-static bool route_part_parse(const struct route_descr *node,
-			     const struct route_part *part,
-			     void *arg)
+int query_arg_span_decode(const char *url,
+			  const struct query_arg_span *arg,
+			  char *buf,
+			  size_t size)
 {
-	if (node->flags & ARG_HEX) {
-		return sscanf(part->str, "%x", (unsigned int *)arg) == 1;
-	} else if (node->flags & ARG_UINT) {
-		return sscanf(part->str, "%u", (unsigned int *)arg) == 1;
-	} else if (node->flags & ARG_STR) {
-		*(const char **)arg = part->str;
-		return true;
-	} else {
-		if (node->part.len != part->len)
+	if (!url || !arg || !query_arg_span_has_value(arg))
+		return -EINVAL;
+
+	return query_value_decode(&url[arg->value.offset], arg->value.len, buf, size);
+}
+
+
+/* Slot layout: 16 bits hash tag | 16 bits (argument index + 1), 0 is empty */
+#define QUERY_INDEX_SLOT(_tag, _i) (((uint32_t)(_tag) << 16u) | ((uint32_t)(_i) + 1u))
+#define QUERY_INDEX_SLOT_TAG(_s) ((_s) >> 16u)
+#define QUERY_INDEX_SLOT_ARG(_s) (((_s) & 0xffffu) - 1u)
+
+/* Seeded hash of a key, bounded by the maximum key length.
+ * Returns false if the key is too long to be indexed.
+ */
+static bool query_index_hash(const char *key, uint32_t seed, uint32_t *hash)
+{
+	uint32_t h = seed ^ 0x811c9dc5u;
+	size_t len = 0u;
+
+	for (; key[len] != '\0'; len++) {
+		if (len >= CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_KEY_LEN)
 			return false;
 
-		if (strncmp(node->part.str, part->str, part->len))
-			return false;
+		h = (h ^ (uint8_t)key[len]) * 0x01000193u;
+	}
+
+	/* Final avalanche (murmur3 fmix32), so that seed affects all bits */
+	h ^= (uint32_t)len;
+	h ^= h >> 16u;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13u;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16u;
+
+	*hash = h;
+
+	return true;
+}
+
+int query_index_build(struct query_index *idx,
+		      struct query_arg qargs[],
+		      size_t count,
+		      uint32_t slots[],
+		      size_t slots_count,
+		      uint32_t seed)
+{
+	if (!idx || (!qargs && count) || !slots)
+		return -EINVAL;
+
+	/* Power of two only, with at least one empty slot */
+	if (!slots_count || (slots_count & (slots_count - 1u)) ||
+	    slots_count <= count)
+		return -ENOMEM;
+
+	if (count > CONFIG_EMBEDC_URL_QUERY_INDEX_MAX_ARGS)
+		return -E2BIG;
+
+	memset(slots, 0, slots_count * sizeof(slots[0u]));
+
+	idx->qargs = qargs;
+	idx->slots = slots;
+	idx->mask = slots_count - 1u;
+	idx->seed = seed;
+
+	int indexed = 0;
+
+	for (size_t i = 0u; i < count; i++) {
+		uint32_t h;
+
+		if (!qargs[i].key || !query_index_hash(qargs[i].key, seed, &h))
+			continue;
+
+		const uint32_t tag = h >> 16u;
+		size_t j = h & idx->mask;
+
+		/* Linear probing, first occurrence of a key wins */
+		while (slots[j]) {
+			if (QUERY_INDEX_SLOT_TAG(slots[j]) == tag &&
+			    strcmp(qargs[QUERY_INDEX_SLOT_ARG(slots[j])].key,
+				   qargs[i].key) == 0)
+				break;
+			j = (j + 1u) & idx->mask;
+		}
+
+		if (!slots[j]) {
+			slots[j] = QUERY_INDEX_SLOT(tag, i);
+			indexed++;
+		}
+	}
+
+	return indexed;
+}
+
+struct query_arg *query_index_find(const struct query_index *idx, const char *key)
+{
+	uint32_t h;
+
+	if (!idx || !key || !query_index_hash(key, idx->seed, &h))
+		return NULL;
+
+	const uint32_t tag = h >> 16u;
+	size_t j = h & idx->mask;
+
+	while (idx->slots[j]) {
+		const uint32_t slot = idx->slots[j];
+		struct query_arg *const arg = &idx->qargs[QUERY_INDEX_SLOT_ARG(slot)];
+
+		if (QUERY_INDEX_SLOT_TAG(slot) == tag && strcmp(arg->key, key) == 0)
+			return query_arg_decode(arg);
+
+		j = (j + 1u) & idx->mask;
+	}
+
+	return NULL;
+}
+
+
+/* Value of 8 decimal digits loaded little-endian, false if not all digits */
+static inline bool dec_swar8(uint64_t v, uint64_t *val)
+{
+	if ((v & 0xf0f0f0f0f0f0f0f0ull) != 0x3030303030303030ull ||
+	    ((v + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) != 0x3030303030303030ull)
+		return false;
+
+	v = ((v & 0x0f0f0f0f0f0f0f0full) * 2561u) >> 8u;
+	v = ((v & 0x00ff00ff00ff00ffull) * 6553601u) >> 16u;
+	*val = ((v & 0x0000ffff0000ffffull) * 42949672960001ull) >> 32u;
+
+	return true;
+}
+
+static inline uint64_t load64_le(const char *str)
+{
+	uint64_t v;
+
+	memcpy(&v, str, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+
+	return v;
+}
+
+/* Whole str must be decimal digits, value at most max */
+static bool dec_parse(const char *str, size_t len, uint64_t max, uint64_t *val)
+{
+	uint64_t n = 0u;
+	size_t i = 0u;
+
+	if (!len)
+		return false;
+
+	/* Long runs 8 digits at a time, can't overflow below 19 digits */
+	while (len - i >= 8u && i + 8u < 20u) {
+		uint64_t d8;
+		if (!dec_swar8(load64_le(&str[i]), &d8))
+			return false;
+		n = n * 100000000u + d8;
+		i += 8u;
+	}
+
+	for (; i < len; i++) {
+		const uint32_t d = (uint32_t)(uint8_t)str[i] - '0';
+		if (d > 9u || n > (max - d) / 10u)
+			return false;
+		n = n * 10u + d;
+	}
+
+	if (n > max)
+		return false;
+
+	*val = n;
+
+	return true;
+}
+
+/* At most digits significant hex digits */
+static bool hex_parse_n(const char *str, size_t len, size_t digits, uint64_t *val)
+{
+	uint64_t n = 0u;
+
+	/* Leading zeros don't count, as with decimal numbers */
+	while (len > 1u && str[0] == '0') {
+		str++;
+		len--;
+	}
+
+	if (!len || len > digits)
+		return false;
+
+	for (size_t i = 0u; i < len; i++) {
+		const int d = hex_digit(str[i]);
+		if (d < 0)
+			return false;
+		n = (n << 4u) | (uint32_t)d;
+	}
+
+	*val = n;
+
+	return true;
+}
+
+/* Optional '-' then decimal digits, value in [-max - 1, max] */
+static bool sint_parse(const char *str, size_t len, uint64_t max, int64_t *val)
+{
+	const bool neg = len && str[0] == '-';
+	uint64_t n;
+
+	if (!dec_parse(str + neg, len - neg, max + neg, &n))
+		return false;
+
+	*val = neg ? (int64_t)(0u - n) : (int64_t)n;
+
+	return true;
+}
+
+static bool uint_parse(const char *str, size_t len, uint32_t *val)
+{
+	uint64_t n;
+
+	if (!dec_parse(str, len, UINT32_MAX, &n))
+		return false;
+
+	*val = (uint32_t)n;
+
+	return true;
+}
+
+static bool hex_parse(const char *str, size_t len, uint32_t *val)
+{
+	uint64_t n;
+
+	if (!hex_parse_n(str, len, 8u, &n))
+		return false;
+
+	*val = (uint32_t)n;
+
+	return true;
+}
+
+/* Numeric argument (ROUTE_ARG_NUMBER flags) spanning the whole part */
+static bool route_arg_parse(uint32_t flags,
+			    const struct route_part *part,
+			    struct route_parse_result *res)
+{
+	const bool wide = flags & ROUTE_ARG_64;
+	uint64_t n;
+
+	if (flags & ROUTE_ARG_INT) {
+		int64_t v;
+		if (!sint_parse(part->str, part->len, wide ? INT64_MAX : INT32_MAX, &v))
+			return false;
+		if (wide)
+			res->sint64 = v;
+		else
+			res->sint = (int32_t)v;
+		return true;
+	} else if (flags & ROUTE_ARG_HEX) {
+		if (!hex_parse_n(part->str, part->len, wide ? 16u : 8u, &n))
+			return false;
+	} else {
+		if (!dec_parse(part->str, part->len, wide ? UINT64_MAX : UINT32_MAX, &n))
+			return false;
+	}
+
+	if (wide)
+		res->uint64 = n;
+	else
+		res->uint = (uint32_t)n;
+
+	return true;
+}
+
+static int query_schema_lookup(const struct query_schema *schema,
+			       const char *key,
+			       size_t len)
+{
+	if (!len || len > UINT8_MAX)
+		return -ENOENT;
+
+	const uint8_t slot = schema->table[
+		query_schema_hash(key, len, schema->seed, schema->bits)];
+	if (!slot)
+		return -ENOENT;
+
+	const struct query_schema_key *const k = &schema->keys[slot - 1u];
+	if (k->len != len || memcmp(k->name, key, len))
+		return -ENOENT;
+
+	return slot - 1u;
+}
+
+int query_schema_parse(const struct query_schema *schema,
+		       char *url,
+		       union query_value values[],
+		       uint32_t *present)
+{
+	if (!schema || !url || !values || !present || schema->count > 32u)
+		return -EINVAL;
+
+	*present = 0u;
+
+	int found = 0;
+
+	/* Arguments are only parsed after the last '?' */
+	char *chr = strrchr(url, '?');
+	chr = chr ? chr + 1u : url;
+
+	for (;;) {
+		const char *const key = chr;
+		while (*chr != '\0' && *chr != '&' && *chr != '=')
+			chr++;
+
+		const size_t klen = chr - key;
+		char *value = NULL;
+
+		/* Value starts after the first '=' of the argument */
+		if (*chr == '=') {
+			value = ++chr;
+			while (*chr != '\0' && *chr != '&')
+				chr++;
+		}
+
+		const char end = *chr;
+		const int id = value ? query_schema_lookup(schema, key, klen) : -ENOENT;
+
+		if (id >= 0 && !(*present & BIT(id))) {
+			const size_t vlen = chr - value;
+			union query_value *const v = &values[id];
+
+			switch (schema->keys[id].type) {
+			case ROUTE_ARG_UINT:
+				if (!uint_parse(value, vlen, &v->uint))
+					return -EINVAL;
+				break;
+			case ROUTE_ARG_HEX:
+				if (!hex_parse(value, vlen, &v->uint))
+					return -EINVAL;
+				break;
+			case ROUTE_ARG_STR:
+				*chr = '\0';
+				query_value_decode(value, vlen, value, vlen + 1u);
+				v->str = value;
+				break;
+			default:
+				return -EINVAL;
+			}
+
+			*present |= BIT(id);
+			found++;
+		}
+
+		if (end == '\0')
+			break;
+
+		chr++; /* Skip '&' */
+	}
+
+	return found;
+}
+
+
+/* Return index of the first '/' from url[i], end if none */
+static size_t route_slash_next(const char *url, size_t i, size_t end)
+{
+	for (; i + CLASSIFY_BLOCK <= end; i += CLASSIFY_BLOCK) {
+		classify_mask_t m = classify_block(&url[i], '/', '/', '/');
+		if (m)
+			return i + classify_next(&m);
+	}
+
+	while (i < end && url[i] != '/')
+		i++;
+
+	return i;
+}
+
+int route_parse(char *url,
+		route_parser_cb_t cb,
+		void *user_data)
+{
+	if (!url || !cb)
+		return -EINVAL;
+
+	int ret;
+	struct route_part s;
+
+	/* Path ends at the first '?' or at the end of the string */
+	const size_t end = strcspn(url, "?");
+	size_t i = 0u;
+
+	/* Remove leading '/' */
+	while (url[i] == '/')
+		i++;
+
+	for (;;) {
+		const size_t slash = route_slash_next(url, i, end);
+
+		url[slash] = '\0'; /* Slice the route */
+		s.str = &url[i];
+		s.len = slash - i;
+
+		ret = cb(&s, user_data);
+		if (ret || slash == end)
+			break;
+
+		i = slash + 1u;
+	}
+
+	/* Return number of chars parsed */
+	return ret ? ret : (int)end + 1;
+}
+
+/* First segment of the path url[0..end), leading '/' removed */
+static inline size_t route_path_start(const char *url, size_t end)
+{
+	size_t i = 0u;
+
+	while (i < end && url[i] == '/')
+		i++;
+
+	return i;
+}
+
+/* Segment of the path url[0..end) starting at *pos, *pos is moved to the
+ * next one. Returns false for the last segment of the path.
+ */
+static inline bool route_split_next(const char *url,
+				    size_t *pos,
+				    size_t end,
+				    struct route_part *p)
+{
+	const size_t slash = route_slash_next(url, *pos, end);
+
+	p->str = &url[*pos];
+	p->len = slash - *pos;
+	*pos = slash + 1u;
+
+	return slash != end;
+}
+
+/* Split the path of url[0..len) into segments, without modifying it.
+ * Returns the index of the end of the path ('?' or len).
+ */
+static int route_split(const char *url,
+		       size_t len,
+		       struct route_part parts[],
+		       size_t *count)
+{
+	const char *const q = memchr(url, '?', len);
+	const size_t end = q ? (size_t)(q - url) : len;
+	size_t pos = route_path_start(url, end);
+	size_t n = 0u;
+	bool more = true;
+
+	while (more) {
+		if (n >= *count)
+			return -ENOMEM;
+
+		more = route_split_next(url, &pos, end, &parts[n++]);
+	}
+
+	*count = n;
+
+	return (int)end;
+}
+
+/* Slice the segments of the path url[0..end) in place */
+static void route_slice(char *url, size_t end)
+{
+	for (size_t i = route_path_start(url, end); i < end; i++) {
+		i = route_slash_next(url, i, end);
+		url[i] = '\0';
+	}
+
+	url[end] = '\0';
+}
+
+int route_segment(char *url, struct route_part parts[], size_t *count)
+{
+	if (!url || !parts || !count || !*count)
+		return -EINVAL;
+
+	/* Path ends at the first '?' or at the end of the string */
+	const int end = route_split(url, strcspn(url, "?"), parts, count);
+	if (end < 0)
+		return end;
+
+	route_slice(url, (size_t)end);
+
+	/* Return number of chars parsed */
+	return end + 1;
+}
+
+/* Return index of the first '/' or '%' from url[i], end if none */
+static size_t route_escape_next(const char *url, size_t i, size_t end)
+{
+	for (; i + CLASSIFY_BLOCK <= end; i += CLASSIFY_BLOCK) {
+		classify_mask_t m = classify_block(&url[i], '/', '%', '/');
+		if (m)
+			return i + classify_next(&m);
+	}
+
+	while (i < end && url[i] != '/' && url[i] != '%')
+		i++;
+
+	return i;
+}
+
+/* Normalize the path url[0..end) in place, see route_segment_normalize().
+ * Segments are compacted at the beginning of url, each one followed by a
+ * NUL, *size is set to the length of this area.
+ */
+static int route_normalize(char *url, size_t end, size_t *size)
+{
+	size_t r = 0u; /* Read index */
+	size_t w = 0u; /* Write index, never ahead of r */
+
+	for (;;) {
+		const size_t seg = w;
+
+		/* Copy the segment, decoding percent-escapes */
+		for (;;) {
+			const size_t run = route_escape_next(url, r, end);
+
+			if (w != r)
+				memmove(&url[w], &url[r], run - r);
+			w += run - r;
+			r = run;
+
+			if (r == end || url[r] == '/')
+				break;
+
+			const int hi = (r + 2u < end) ? hex_digit(url[r + 1u]) : -1;
+			const int lo = (hi >= 0) ? hex_digit(url[r + 2u]) : -1;
+
+			if (lo >= 0) {
+				/* Decoded NUL would truncate the segment */
+				if (!hi && !lo)
+					return -EINVAL;
+
+				url[w++] = (char)((hi << 4) | lo);
+				r += 3u;
+			} else {
+				/* Invalid escape sequence, keep it as is */
+				url[w++] = '%';
+				r++;
+			}
+		}
+
+		const size_t len = w - seg;
+
+		if (len == 0u || (len == 1u && url[seg] == '.')) {
+			/* Duplicate slash or "." segment */
+			w = seg;
+		} else if (len == 2u && url[seg] == '.' && url[seg + 1u] == '.') {
+			/* ".." removes the previous segment, if any,
+			 * segments contain no NUL so it is found backwards
+			 */
+			w = seg;
+			if (w) {
+				w--;
+				while (w && url[w - 1u] != '\0')
+					w--;
+			}
+		} else {
+			url[w++] = '\0'; /* Slice the route */
+		}
+
+		if (r == end)
+			break;
+
+		r++; /* Skip '/' */
+	}
+
+	url[end] = '\0';
+	*size = w;
+
+	return 0;
+}
+
+int route_segment_normalize(char *url, struct route_part parts[], size_t *count)
+{
+	if (!url || !parts || !count || !*count)
+		return -EINVAL;
+
+	/* Path ends at the first '?' or at the end of the string */
+	const size_t end = strcspn(url, "?");
+	size_t size;
+	size_t n = 0u;
+
+	int ret = route_normalize(url, end, &size);
+	if (ret)
+		return ret;
+
+	for (size_t i = 0u; i < size; i += parts[n++].len + 1u) {
+		if (n >= *count)
+			return -ENOMEM;
+
+		parts[n].str = &url[i];
+		parts[n].len = strlen(&url[i]);
+	}
+
+	*count = n;
+
+	/* Return number of chars parsed */
+	return (int)end + 1;
+}
+
+static inline bool is_leaf(const struct route_descr *descr)
+{
+	return (descr->flags & ROUTE_IS_LEAF_MASK) == ROUTE_IS_LEAF;
+}
+
+int route_tree_iterate(const struct route_descr *root,
+		       size_t size,
+		       route_tree_iter_cb_t cb,
+		       void *user_data)
+{
+	if (!root || !size || !cb)
+		return -EINVAL;
+
+	const struct route_descr *parents[CONFIG_EMBEDC_URL_PARSER_ITER_MAX_DEPTH];
+	size_t depth = 0u;
+	size_t routes_count = 0u;
+
+	const struct route_descr *first = root;
+	const struct route_descr *node = first;
+	size_t children_count = size;
+
+	while (node) {
+		if (cb(node, parents, depth, user_data) == false)
+			goto exit;
+
+		if (is_leaf(node)) {
+			routes_count++;
+
+			const size_t index = node - first;
+			if (index < children_count - 1u) {
+				node++;
+				continue;
+			}
+
+			do {
+				if (depth == 0u)
+					goto exit;
+
+				node = parents[--depth] + 1u;
+				if (depth == 0) {
+					first = root;
+					children_count = size;
+				} else {
+					first = parents[depth - 1u]->children.list;
+					children_count = parents[depth - 1u]->children.count;
+				}
+			} while (node - first >= (int)children_count);
+		} else {
+			if (depth >= CONFIG_EMBEDC_URL_PARSER_ITER_MAX_DEPTH)
+				return -EOVERFLOW;
+
+			parents[depth++] = node;
+			children_count = node->children.count;
+			first = node->children.list;
+			node = first;
+		}
+	}
+
+exit:
+	return routes_count;
+}
+
+/* Parts are not necessarily NUL-terminated, numbers must span the whole part */
+static bool route_part_parse(const struct route_descr *node,
+			     const struct route_part *part,
+			     struct route_parse_result *res)
+{
+	if (node->flags & ROUTE_ARG_NUMBER) {
+		return route_arg_parse(node->flags, part, res);
+	} else if (node->flags & ARG_STR) {
+		res->part = *part;
+		return true;
+	} else {
+		if (node->part.len != part->len)
+			return false;
+
+		if (strncmp(node->part.str, part->str, part->len))
+			return false;
+
+		res->part = *part;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Route resolution state
+ */
+struct route_resolve_context
+{
+	/**
+	 * @brief Last descriptor being matched
+	 */
+	const struct route_descr *descr;
+
+	/**
+	 * @brief Children count of the last section being matched
+	 *
+	 * If route has been found, this value is 0. It can be used to know
+	 * whether we expect more parts in the route or not.
+	 */
+	size_t child_count;
+
+	/**
+	 * @brief Static children lookup of the last section, NULL if none
+	 */
+	const struct route_lookup *lookup;
+
+	/**
+	 * @brief Current memory block to store matched route part.
+	 *
+	 * Note: Should be initialized to the beginning of an array
+	 */
+	struct route_parse_result *result;
+
+	/**
+	 * @brief Remaining number of elements
+	 *
+	 * Note: Should be initialized  to the size of the array
+	 */
+	size_t results_remaining;
+
+	/**
+	 * Flags value to match
+	 */
+	uint32_t flags;
+
+	/**
+	 * @brief Flags mask to match
+	 */
+	uint32_t mask;
+
+	/**
+	 * @brief Depth of the current route
+	 */
+	uint32_t depth;
+};
+
+static inline bool route_found(struct route_resolve_context *x)
+{
+	return x->child_count == 0u;
+}
+
+static inline void mark_route_found(struct route_resolve_context *x)
+{
+	x->child_count = 0u;
+}
+
+static inline bool node_matches_flags(const struct route_descr *descr,
+				      uint32_t flags,
+				      uint32_t mask)
+{
+	return (descr->flags & mask) == (flags & mask);
+}
+
+/* Try to match a child with the segment and move the context to it */
+static bool route_node_match(const struct route_descr *node,
+			     const struct route_part *p,
+			     struct route_resolve_context *x)
+{
+	if (route_part_parse(node, p, x->result) == false)
+		return false;
+
+	if (is_leaf(node)) {
+		/* Leaf flags should match */
+		if (!node_matches_flags(node, x->flags, x->mask))
+			return false;
+
+		x->descr = node;
+		mark_route_found(x);
+	} else {
+		/* Prepare context for next call */
+		x->descr = node->children.list;
+		x->child_count = node->children.count;
+		x->lookup = node->children.lookup;
+	}
+
+	x->result->depth = ++x->depth;
+	x->result->descr = node;
+	x->result = --x->results_remaining > 0u ? x->result + 1u : NULL;
+
+	return true;
+}
+
+/* Order of names in generated sections, as memcmp() then shorter first */
+static int route_name_cmp(const struct route_part *a, const struct route_part *b)
+{
+	const int r = memcmp(a->str, b->str, MIN(a->len, b->len));
+	if (r)
+		return r;
+
+	return (a->len > b->len) - (a->len < b->len);
+}
+
+/* First child named as the segment, among sorted children [lo, hi) */
+static const struct route_descr *route_jump_find(const struct route_descr *first,
+						 size_t lo,
+						 size_t hi,
+						 const struct route_part *p)
+{
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2u;
+
+		if (route_name_cmp(&first[mid].part, p) < 0)
+			lo = mid + 1u;
+		else
+			hi = mid;
+	}
+
+	return &first[lo];
+}
+
+/* Static candidates are found with one probe in the hash table, or by a
+ * binary search between the bounds given by the jump table. Children with
+ * the same name are then verified in order, typed children are only tried
+ * on a miss.
+ */
+static const struct route_descr *route_lookup_first(const struct route_lookup *lk,
+						    const struct route_descr *first,
+						    const struct route_part *p)
+{
+	const struct route_descr *node = NULL;
+
+	if (lk->table) {
+		const uint8_t i = lk->table[query_schema_hash(p->str, p->len, lk->seed, lk->bits)];
+		if (i && i <= lk->typed)
+			node = &first[i - 1u];
+	} else {
+		const size_t b = (uint8_t)p->str[0u] - (size_t)lk->lo;
+		if ((uint8_t)p->str[0u] >= lk->lo && b < lk->count)
+			node = route_jump_find(first, lk->jump[b], lk->jump[b + 1u], p);
+	}
+
+	return node;
+}
+
+static int route_tree_resolve_lookup(const struct route_part *p,
+				     struct route_resolve_context *x)
+{
+	const struct route_lookup *const lk = x->lookup;
+	const struct route_descr *const first = x->descr;
+	const struct route_descr *node = route_lookup_first(lk, first, p);
+
+	for (; node && node < first + lk->typed; node++) {
+		if (node->part.len != p->len ||
+		    strncmp(node->part.str, p->str, p->len))
+			break;
+
+		if (route_node_match(node, p, x) == true)
+			return 0;
+	}
+
+	for (node = first + lk->typed; node < first + x->child_count; node++) {
+		if (route_node_match(node, p, x) == true)
+			return 0;
+	}
+
+	return -ENOENT;
+}
+
+static int route_tree_resolve_cb(const struct route_part *p,
+				 struct route_resolve_context *x)
+{
+	/* If we found the route but there is more, then we return an error
+	 * In order to ignore trailing '/', we just ignore empty parts
+	 */
+	if ((p->len != 0u) && (route_found(x) == true)) {
+		return -ENOENT;
+	}
+
+	if (!x->result) {
+		return -ENOMEM;
+	}
+
+	/* Unnamed children are not indexed */
+	if (x->lookup && p->len)
+		return route_tree_resolve_lookup(p, x);
+
+	const struct route_descr *node;
+	for (node = x->descr; node < x->descr + x->child_count; node++) {
+		if (route_node_match(node, p, x) == true)
+			return 0;
+	}
+
+	return -ENOENT;
+}
+
+static const struct route_descr *
+find_section_leaf(const struct route_descr *section_first_child,
+		  size_t count,
+		  uint32_t flags,
+		  uint32_t mask)
+{
+	const struct route_descr *leaf = NULL;
+
+	/* Search for leaf */
+	flags |= ROUTE_IS_LEAF;
+	mask |= ROUTE_IS_LEAF;
+
+	for (const struct route_descr *node = section_first_child;
+	     node < section_first_child + count;
+	     node++) {
+		/* Find unamed leaf which matches flags */
+		if (!node->part.len && node_matches_flags(node, flags, mask)) {
+			leaf = node;
+			break;
+		}
+	}
+
+	return leaf;
+}
+
+/* Find the leaf once all segments are resolved,
+ * path_end is the end of the path (the unnamed leaf part)
+ */
+static const struct route_descr *route_tree_resolve_end(struct route_resolve_context *x,
+							const char *path_end)
+{
+	const struct route_descr *leaf = NULL;
+
+	if (x->descr) {
+		if (is_leaf(x->descr) && route_found(x)) {
+			leaf = x->descr;
+		} else {
+			/**
+			 * @brief If we end up on a section, we need to find the
+			 * unamed leaf which matches the flags.
+			 */
+			leaf = find_section_leaf(x->descr, x->child_count,
+						 x->flags, x->mask);
+			if (!x->result) {
+				leaf = NULL;
+			} else if (leaf) {
+				x->result->depth = x->depth + 1u;
+				x->result->descr = leaf;
+				x->result->part.str = path_end;
+				x->result->part.len = 0u;
+				x->results_remaining--;
+			}
+		}
+	}
+
+	return leaf;
+}
+
+/* Resolve segments, path_end is the end of the path (the unnamed leaf part) */
+static const struct route_descr *route_tree_resolve_parts(struct route_resolve_context *x,
+							  const struct route_part parts[],
+							  size_t count,
+							  const char *path_end)
+{
+	for (size_t i = 0u; i < count; i++) {
+		if (route_tree_resolve_cb(&parts[i], x))
+			return NULL;
+	}
+
+	return route_tree_resolve_end(x, path_end);
+}
+
+/* Resolve the segments of the path url[0..end) as they are split, so the
+ * number of segments is not bounded
+ */
+static const struct route_descr *route_tree_resolve_path(struct route_resolve_context *x,
+							 const char *url,
+							 size_t end)
+{
+	struct route_part p;
+	size_t pos = route_path_start(url, end);
+	bool more;
+
+	do {
+		more = route_split_next(url, &pos, end, &p);
+		if (route_tree_resolve_cb(&p, x))
+			return NULL;
+	} while (more);
+
+	return route_tree_resolve_end(x, url + end);
+}
+
+#if defined(CONFIG_EMBEDC_URL_PARSER_NORMALIZE)
+/* Resolve the segments left by route_normalize() in url[0..size) */
+static const struct route_descr *route_tree_resolve_normalized(struct route_resolve_context *x,
+							       const char *url,
+							       size_t size,
+							       const char *path_end)
+{
+	struct route_part p;
+
+	for (size_t i = 0u; i < size; i += p.len + 1u) {
+		p.str = &url[i];
+		p.len = strlen(p.str);
+
+		if (route_tree_resolve_cb(&p, x))
+			return NULL;
+	}
+
+	return route_tree_resolve_end(x, path_end);
+}
+#endif /* CONFIG_EMBEDC_URL_PARSER_NORMALIZE */
+
+/* Children resolved first: the root array, or the children of a root
+ * section (size ROUTE_ROOT_SECTION) with its lookup
+ */
+static bool route_root_children(const struct route_descr *root,
+				size_t size,
+				const struct route_descr **list,
+				size_t *count,
+				const struct route_lookup **lookup)
+{
+	if (!root || !size)
+		return false;
+
+	if (size == ROUTE_ROOT_SECTION) {
+		if (is_leaf(root))
+			return false;
+
+		*list = root->children.list;
+		*count = root->children.count;
+		*lookup = root->children.lookup;
+	} else {
+		*list = root;
+		*count = size;
+		*lookup = NULL;
+	}
+
+	return *list && *count;
+}
+
+const struct route_descr *route_tree_resolve(const struct route_descr *root,
+					     size_t size,
+					     char *url,
+					     uint32_t flags,
+					     uint32_t mask,
+					     struct route_parse_result *results,
+					     size_t *results_count,
+					     char **query_string)
+{
+	const struct route_descr *leaf = NULL;
+	const struct route_lookup *lookup;
+
+	if (!route_root_children(root, size, &root, &size, &lookup) ||
+	    !url || !results || !results_count || !*results_count)
+		goto exit;
+
+	struct route_resolve_context x = {
+		.descr = root,
+		.child_count = size,
+		.lookup = lookup,
+		.result = &results[0u],
+		.results_remaining = *results_count,
+		.flags = flags,
+		.mask = mask,
+		.depth = 0u,
+	};
+
+	/* Path ends at the first '?' or at the end of the string */
+	const size_t end = strcspn(url, "?");
+
+#if defined(CONFIG_EMBEDC_URL_PARSER_NORMALIZE)
+	size_t normalized;
+
+	if (route_normalize(url, end, &normalized) == 0) {
+		leaf = route_tree_resolve_normalized(&x, url, normalized, url + end);
+	}
+#else
+	leaf = route_tree_resolve_path(&x, url, end);
+	route_slice(url, end);
+#endif
+
+	if (leaf) {
+		*results_count -= x.results_remaining;
+
+		if (query_string) {
+			*query_string = url + end + 1u;
+		}
+	} else {
+		*results_count = 0u;
+	}
+
+exit:
+	return leaf;
+}
+
+/* Resolve from a children list, lookup is NULL if it has none */
+static const struct route_descr *route_children_resolve_const(const struct route_descr *list,
+							      size_t count,
+							      const struct route_lookup *lookup,
+							      const char *url,
+							      size_t len,
+							      uint32_t flags,
+							      uint32_t mask,
+							      struct route_parse_result *results,
+							      size_t *results_count,
+							      const char **query_string)
+{
+	int end;
+	const struct route_descr *leaf = NULL;
+
+	if (!list || !count || !url || !results || !results_count || !*results_count)
+		goto exit;
+
+	struct route_resolve_context x = {
+		.descr = list,
+		.child_count = count,
+		.lookup = lookup,
+		.result = &results[0u],
+		.results_remaining = *results_count,
+		.flags = flags,
+		.mask = mask,
+		.depth = 0u,
+	};
+
+	const char *const q = memchr(url, '?', len);
+	end = q ? (int)(q - url) : (int)len;
+
+	leaf = route_tree_resolve_path(&x, url, (size_t)end);
+
+	if (leaf) {
+		*results_count -= x.results_remaining;
+
+		if (query_string) {
+			*query_string = ((size_t)end < len) ? url + end + 1u : url + len;
+		}
+	} else {
+		*results_count = 0u;
+	}
+
+exit:
+	return leaf;
+}
+
+const struct route_descr *route_tree_resolve_const(const struct route_descr *root,
+						   size_t size,
+						   const char *url,
+						   size_t len,
+						   uint32_t flags,
+						   uint32_t mask,
+						   struct route_parse_result *results,
+						   size_t *results_count,
+						   const char **query_string)
+{
+	const struct route_descr *list;
+	const struct route_lookup *lookup;
+	size_t count;
+
+	if (!route_root_children(root, size, &list, &count, &lookup)) {
+		if (results_count)
+			*results_count = 0u;
+		return NULL;
+	}
+
+	return route_children_resolve_const(list, count, lookup, url, len, flags, mask,
+					    results, results_count, query_string);
+}
+
+const struct route_descr *route_section_resolve_const(const struct route_descr *section,
+						      const char *url,
+						      size_t len,
+						      uint32_t flags,
+						      uint32_t mask,
+						      struct route_parse_result *results,
+						      size_t *results_count,
+						      const char **query_string)
+{
+	return route_tree_resolve_const(section, ROUTE_ROOT_SECTION, url, len, flags,
+					mask, results, results_count, query_string);
+}
+
+/* Candidates of a section for a segment, static children then typed ones */
+struct route_bt_level
+{
+	const struct route_descr *list;
+	size_t count;
+
+	/* Static candidates are the same-name group found by the lookup */
+	const struct route_lookup *lookup;
+
+	/* Next candidate */
+	const struct route_descr *node;
+
+	bool typed;
+};
+
+/* Sections (children lists) known to fail from a segment, oldest
+ * entries are replaced first
+ */
+struct route_bt_memo
+{
+	const struct route_descr *lists[CONFIG_EMBEDC_URL_PARSER_BACKTRACK_MEMO];
+	size_t next;
+};
+
+static void route_bt_enter(struct route_bt_level *lv,
+			   const struct route_descr *list,
+			   size_t count,
+			   const struct route_lookup *lookup,
+			   const struct route_part *p)
+{
+	lv->list = list;
+	lv->count = count;
+	lv->lookup = (lookup && p->len) ? lookup : NULL;
+	lv->node = list;
+	lv->typed = false;
+
+	if (lv->lookup) {
+		lv->node = route_lookup_first(lookup, list, p);
+		if (!lv->node) {
+			lv->node = list + lookup->typed;
+			lv->typed = true;
+		}
+	}
+}
+
+static const struct route_descr *route_bt_next(struct route_bt_level *lv,
+					       const struct route_part *p,
+					       struct route_parse_result *res,
+					       uint32_t flags,
+					       uint32_t mask)
+{
+	const struct route_descr *const end = lv->list + lv->count;
+
+	for (;;) {
+		if (!lv->typed) {
+			const bool done = lv->lookup ?
+				(lv->node >= lv->list + lv->lookup->typed ||
+				 lv->node->part.len != p->len ||
+				 strncmp(lv->node->part.str, p->str, p->len)) :
+				lv->node >= end;
+
+			if (done) {
+				lv->node = lv->lookup ? lv->list + lv->lookup->typed : lv->list;
+				lv->typed = true;
+				continue;
+			}
+		} else if (lv->node >= end) {
+			return NULL;
+		}
+
+		const struct route_descr *const node = lv->node++;
+
+		if (((node->flags & ROUTE_ARG_MASK) != 0u) != lv->typed)
+			continue;
+
+		if (!route_part_parse(node, p, res))
+			continue;
+
+		/* Leaf flags should match */
+		if (is_leaf(node) && !node_matches_flags(node, flags, mask))
+			continue;
+
+		return node;
+	}
+}
+
+static inline bool route_bt_failed(const struct route_bt_memo *memo,
+				   const struct route_descr *list)
+{
+	for (size_t i = 0u; i < ARRAY_SIZE(memo->lists); i++) {
+		if (memo->lists[i] == list)
+			return true;
+	}
+
+	return false;
+}
+
+static inline void route_bt_fail(struct route_bt_memo *memo,
+				 const struct route_descr *list)
+{
+	memo->lists[memo->next] = list;
+	memo->next = (memo->next + 1u) % ARRAY_SIZE(memo->lists);
+}
+
+const struct route_descr *route_tree_resolve_backtrack(const struct route_descr *root,
+						       size_t size,
+						       const char *url,
+						       size_t len,
+						       uint32_t flags,
+						       uint32_t mask,
+						       struct route_parse_result *results,
+						       size_t *results_count,
+						       const char **query_string)
+{
+	int end;
+	const struct route_descr *leaf = NULL;
+	const struct route_descr *list;
+	const struct route_lookup *lookup;
+	size_t list_count;
+	size_t count = 0u;
+
+	if (!route_root_children(root, size, &list, &list_count, &lookup) ||
+	    !url || !results || !results_count || !*results_count)
+		goto exit;
+
+	struct route_part parts[CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS];
+	size_t parts_count = ARRAY_SIZE(parts);
+
+	end = route_split(url, len, parts, &parts_count);
+	if (end < 0) {
+		/* Deeper than the backtracking stack, walk without it */
+		return route_tree_resolve_const(root, size, url, len, flags, mask,
+						results, results_count, query_string);
+	}
+
+	struct route_bt_level levels[CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS];
+	struct route_bt_memo memo[CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS];
+	size_t i = 0u;
+
+	memset(memo, 0, sizeof(memo));
+	route_bt_enter(&levels[0u], list, list_count, lookup, &parts[0u]);
+
+	for (;;) {
+		const struct route_descr *const node =
+			route_bt_next(&levels[i], &parts[i], &results[i], flags, mask);
+
+		if (!node) {
+			/* Dead end, go back to the parent section */
+			route_bt_fail(&memo[i], levels[i].list);
+			if (i == 0u)
+				goto exit;
+			i--;
+			continue;
+		}
+
+		results[i].depth = i + 1u;
+		results[i].descr = node;
+
+		if (i + 1u == parts_count) {
+			if (is_leaf(node)) {
+				leaf = node;
+				count = i + 1u;
+				break;
+			}
+
+			/* Ending on a section, find its unnamed leaf */
+			if (i + 1u < *results_count) {
+				leaf = find_section_leaf(node->children.list,
+							 node->children.count,
+							 flags, mask);
+			}
+
+			if (leaf) {
+				results[i + 1u].depth = i + 2u;
+				results[i + 1u].descr = leaf;
+				results[i + 1u].part.str = url + end;
+				results[i + 1u].part.len = 0u;
+				count = i + 2u;
+				break;
+			}
+		} else if (!is_leaf(node) && i + 1u < *results_count &&
+			   !route_bt_failed(&memo[i + 1u], node->children.list)) {
+			i++;
+			route_bt_enter(&levels[i], node->children.list,
+				       node->children.count, node->children.lookup,
+				       &parts[i]);
+		}
+
+		/* Otherwise try the next candidate */
+	}
+
+	if (query_string) {
+		*query_string = ((size_t)end < len) ? url + end + 1u : url + len;
+	}
+
+exit:
+	if (results_count)
+		*results_count = count;
+
+	return leaf;
+}
+
+int route_cache_init(struct route_cache *cache,
+		     struct route_cache_entry entries[],
+		     size_t count)
+{
+	if (!cache || !entries || !count || (count & (count - 1u)))
+		return -EINVAL;
+
+	cache->entries = entries;
+	cache->count = count;
+	cache->hits = 0u;
+	cache->misses = 0u;
+
+	route_cache_invalidate(cache);
+
+	return 0;
+}
+
+void route_cache_invalidate(struct route_cache *cache)
+{
+	for (size_t i = 0u; i < cache->count; i++)
+		cache->entries[i].count = 0u;
+
+	cache->version = NULL;
+	cache->generation = 0u;
+	cache->root = NULL;
+	cache->size = 0u;
+}
+
+/* Hash of the path, 8 bytes at a time */
+static uint32_t route_cache_hash(const char *path, size_t len, uint32_t flags)
+{
+	uint64_t h = ((uint64_t)flags << 32u) ^ (len * 0x9e3779b97f4a7c15ull);
+	uint64_t v;
+
+	for (; len >= 8u; path += 8u, len -= 8u) {
+		h = (h ^ load64_le(path)) * 0x9e3779b97f4a7c15ull;
+		h ^= h >> 29u;
+	}
+
+	if (len) {
+		v = 0u;
+		memcpy(&v, path, len);
+		h = (h ^ v) * 0x9e3779b97f4a7c15ull;
+		h ^= h >> 29u;
+	}
+
+	return (uint32_t)(h ^ (h >> 32u));
+}
+
+static bool route_cache_hit(const struct route_cache_entry *e,
+			    const char *url,
+			    size_t end,
+			    struct route_parse_result *results,
+			    size_t *results_count)
+{
+	if (e->count > *results_count)
+		return false;
+
+	for (size_t i = 0u; i < e->count; i++) {
+		const struct route_descr *const descr = e->descrs[i];
+		struct route_part p = {
+			.str = url + end,
+			.len = 0u,
+		};
+
+		/* Last result can be the unnamed leaf of a section */
+		if (i < e->parts) {
+			const size_t next = (i + 1u < e->parts) ? e->offsets[i + 1u] - 1u : end;
+
+			p.str = url + e->offsets[i];
+			p.len = next - e->offsets[i];
+		}
+
+		if (descr->flags & ROUTE_ARG_NUMBER) {
+			route_arg_parse(descr->flags, &p, &results[i]);
+		} else {
+			results[i].part = p;
+		}
+
+		results[i].depth = i + 1u;
+		results[i].descr = descr;
+	}
+
+	*results_count = e->count;
+
+	return true;
+}
+
+static void route_cache_fill(struct route_cache_entry *e,
+			     uint32_t hash,
+			     const char *url,
+			     size_t end,
+			     const struct route_part parts[],
+			     size_t parts_count,
+			     const struct route_parse_result *results,
+			     size_t count,
+			     uint32_t flags,
+			     uint32_t mask)
+{
+	if (end > CONFIG_EMBEDC_URL_PARSER_CACHE_PATH_MAX || end > UINT8_MAX ||
+	    count > CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH)
+		return;
+
+	e->hash = hash;
+	e->flags = flags;
+	e->mask = mask;
+	e->len = (uint8_t)end;
+	e->parts = (uint8_t)parts_count;
+	e->count = (uint8_t)count;
+
+	for (size_t i = 0u; i < count; i++) {
+		e->descrs[i] = results[i].descr;
+		if (i < parts_count)
+			e->offsets[i] = (uint8_t)(parts[i].str - url);
+	}
+
+	memcpy(e->path, url, end);
+}
+
+const struct route_descr *route_cache_resolve(struct route_cache *cache,
+					      const struct route_table_version *version,
+					      const char *url,
+					      size_t len,
+					      uint32_t flags,
+					      uint32_t mask,
+					      struct route_parse_result *results,
+					      size_t *results_count,
+					      const char **query_string)
+{
+	const struct route_descr *leaf = NULL;
+
+	if (!cache || !version || !version->root || !version->size || !url ||
+	    !results || !results_count || !*results_count)
+		goto exit;
+
+	const struct route_descr *const root = version->root;
+	const size_t size = version->size;
+	const struct route_descr *list;
+	const struct route_lookup *lookup;
+	size_t count;
+
+	if (!route_root_children(root, size, &list, &count, &lookup))
+		goto exit;
+
+	/* A version can be published again with another tree */
+	if (cache->version != version || cache->generation != version->generation ||
+	    cache->root != root || cache->size != size) {
+		route_cache_invalidate(cache);
+		cache->version = version;
+		cache->generation = version->generation;
+		cache->root = root;
+		cache->size = size;
+	}
+
+	const char *const q = memchr(url, '?', len);
+	const size_t end = q ? (size_t)(q - url) : len;
+
+	flags &= mask;
+
+	const uint32_t hash = route_cache_hash(url, end, flags);
+	struct route_cache_entry *const e = &cache->entries[hash & (cache->count - 1u)];
+
+	if (e->count && e->hash == hash && e->len == end &&
+	    e->flags == flags && e->mask == mask && !memcmp(e->path, url, end)) {
+		if (!route_cache_hit(e, url, end, results, results_count)) {
+			*results_count = 0u;
+			goto exit;
+		}
+
+		cache->hits++;
+		leaf = e->descrs[e->count - 1u];
+	} else {
+		struct route_resolve_context x = {
+			.descr = list,
+			.child_count = count,
+			.lookup = lookup,
+			.result = &results[0u],
+			.results_remaining = *results_count,
+			.flags = flags,
+			.mask = mask,
+			.depth = 0u,
+		};
+
+		struct route_part parts[CONFIG_EMBEDC_URL_PARSER_CACHE_DEPTH];
+		size_t parts_count = ARRAY_SIZE(parts);
+		bool fill = true;
+
+		cache->misses++;
+
+		if (route_split(url, end, parts, &parts_count) >= 0) {
+			leaf = route_tree_resolve_parts(&x, parts, parts_count, url + end);
+		} else {
+			/* Too deep to be cached */
+			leaf = route_tree_resolve_path(&x, url, end);
+			fill = false;
+		}
+
+		if (!leaf) {
+			*results_count = 0u;
+			goto exit;
+		}
+
+		*results_count -= x.results_remaining;
+
+		if (fill) {
+			route_cache_fill(e, hash, url, end, parts, parts_count,
+					 results, *results_count, flags, mask);
+		}
+	}
+
+	if (query_string) {
+		*query_string = (end < len) ? url + end + 1u : url + len;
+	}
+
+exit:
+	return leaf;
+}
+
+/* Walk of a batch URL, one segment at a time */
+struct route_batch_lane
+{
+	struct route_resolve_context x;
+	struct route_batch *item;
+	size_t pos;
+	size_t end;
+	bool failed;
+};
+
+static void route_batch_start(struct route_batch_lane *l,
+			      const struct route_descr *list,
+			      size_t count,
+			      const struct route_lookup *lookup,
+			      uint32_t mask,
+			      struct route_batch *item)
+{
+	l->item = item;
+	l->failed = !item->url || !item->results || !item->results_count;
+	l->pos = 0u;
+	l->end = 0u;
+
+	if (l->failed)
+		return;
+
+	l->x = (struct route_resolve_context){
+		.descr = list,
+		.child_count = count,
+		.lookup = lookup,
+		.result = &item->results[0u],
+		.results_remaining = item->results_count,
+		.flags = item->flags,
+		.mask = mask,
+		.depth = 0u,
+	};
+
+	const char *const q = memchr(item->url, '?', item->len);
+	l->end = q ? (size_t)(q - item->url) : item->len;
+	l->pos = route_path_start(item->url, l->end);
+}
+
+/* Resolve the next segment, false once the walk is over */
+static bool route_batch_step(struct route_batch_lane *l)
+{
+	if (l->failed)
+		return false;
+
+	struct route_part p;
+	const bool more = route_split_next(l->item->url, &l->pos, l->end, &p);
+
+	if (route_tree_resolve_cb(&p, &l->x)) {
+		l->failed = true;
+		return false;
+	}
+
+	/* Next segment of this URL is resolved after the other lanes */
+	ROUTE_PREFETCH(l->x.descr);
+	if (l->x.lookup)
+		ROUTE_PREFETCH(l->x.lookup);
+
+	return more;
+}
+
+static bool route_batch_finish(struct route_batch_lane *l)
+{
+	struct route_batch *const item = l->item;
+	const struct route_descr *leaf = NULL;
+
+	if (!l->failed)
+		leaf = route_tree_resolve_end(&l->x, item->url + l->end);
+
+	item->leaf = leaf;
+
+	if (leaf) {
+		item->results_count -= l->x.results_remaining;
+		item->query_string = (l->end < item->len) ?
+			item->url + l->end + 1u : item->url + item->len;
+	} else {
+		item->results_count = 0u;
+		item->query_string = NULL;
+	}
+
+	return leaf != NULL;
+}
+
+size_t route_tree_resolve_batch(const struct route_descr *root,
+				size_t size,
+				uint32_t mask,
+				struct route_batch batch[],
+				size_t count)
+{
+	struct route_batch_lane lanes[CONFIG_EMBEDC_URL_PARSER_BATCH_WIDTH];
+	size_t active = 0u;
+	size_t next = 0u;
+	size_t resolved = 0u;
+	const struct route_lookup *lookup;
+
+	if (!route_root_children(root, size, &root, &size, &lookup) || !batch)
+		return 0u;
+
+	while (active < ARRAY_SIZE(lanes) && next < count)
+		route_batch_start(&lanes[active++], root, size, lookup, mask,
+				  &batch[next++]);
+
+	/* Round-robin over the lanes, a finished lane takes the next URL */
+	while (active) {
+		for (size_t i = 0u; i < active;) {
+			if (route_batch_step(&lanes[i])) {
+				i++;
+				continue;
+			}
+
+			if (route_batch_finish(&lanes[i]))
+				resolved++;
+
+			if (next < count) {
+				route_batch_start(&lanes[i], root, size, lookup, mask,
+						  &batch[next++]);
+				i++;
+			} else {
+				lanes[i] = lanes[--active];
+			}
+		}
+	}
+
+	return resolved;
+}
+
+/* The walk state is kept in the stream, the context is only built for
+ * the duration of a call
+ */
+static void route_stream_load(const struct route_stream *rs,
+			      struct route_resolve_context *x)
+{
+	const size_t matched = rs->results_size - rs->results_remaining;
+
+	*x = (struct route_resolve_context) {
+		.descr = rs->descr,
+		.child_count = rs->child_count,
+		.lookup = rs->lookup,
+		.result = rs->results_remaining ? &rs->results[matched] : NULL,
+		.results_remaining = rs->results_remaining,
+		.flags = rs->flags,
+		.mask = rs->mask,
+		.depth = rs->depth,
+	};
+}
+
+static void route_stream_store(struct route_stream *rs,
+			       const struct route_resolve_context *x)
+{
+	rs->descr = x->descr;
+	rs->child_count = x->child_count;
+	rs->lookup = x->lookup;
+	rs->results_remaining = x->results_remaining;
+	rs->depth = x->depth;
+}
+
+/* Segment of an incremental resolution: results must not point to the
+ * segment, which is only valid during the call.
+ */
+static int route_stream_segment(struct route_stream *rs,
+				const struct url_stream_token *t)
+{
+	const struct route_part p = {
+		.str = t->key,
+		.len = t->key_len,
+	};
+
+	struct route_resolve_context x;
+
+	route_stream_load(rs, &x);
+
+	int ret = route_tree_resolve_cb(&p, &x);
+	if (ret)
+		return ret;
+
+	route_stream_store(rs, &x);
+
+	struct route_parse_result *const res = &rs->results[rs->depth - 1u];
+
+	if (res->descr->flags & ARG_STR) {
+		/* Keep a NUL-terminated copy, the segment may already be
+		 * at this place in the carry area.
+		 */
+		if (p.len >= rs->size - rs->strs_len)
+			return -ENOMEM;
+
+		char *const str = &rs->buf[rs->strs_len];
+		memmove(str, p.str, p.len);
+		str[p.len] = '\0';
+		rs->strs_len += p.len + 1u;
+
+		res->part.str = str;
+		res->part.len = p.len;
+
+		/* Carry area shrinks, it is empty between two segments */
+		rs->url.buf = &rs->buf[rs->strs_len];
+		rs->url.size = rs->size - rs->strs_len;
+	} else if (!(res->descr->flags & ROUTE_ARG_NUMBER)) {
+		res->part = res->descr->part;
+	}
+
+	return 0;
+}
+
+static int route_stream_path_end(struct route_stream *rs)
+{
+	struct route_resolve_context x;
+
+	route_stream_load(rs, &x);
+	rs->leaf = route_tree_resolve_end(&x, "");
+	route_stream_store(rs, &x);
+
+	return rs->leaf ? 1 : -ENOENT;
+}
+
+static int route_stream_cb(enum url_stream_event event,
+			   const struct url_stream_token *token,
+			   void *user_data)
+{
+	struct route_stream *rs = user_data;
+
+	if (rs->status)
+		return 0;
+
+	switch (event) {
+	case URL_STREAM_SEGMENT:
+		rs->status = route_stream_segment(rs, token);
+		break;
+	case URL_STREAM_PATH_END:
+		rs->status = route_stream_path_end(rs);
+		break;
+	default:
+		break;
+	}
+
+	return rs->status < 0 ? rs->status : 0;
+}
+
+void route_stream_init(struct route_stream *rs,
+		       const struct route_descr *root,
+		       size_t size,
+		       uint32_t flags,
+		       uint32_t mask,
+		       struct route_parse_result *results,
+		       size_t results_size,
+		       char *buf,
+		       size_t buf_size)
+{
+	const bool valid = route_root_children(root, size, &rs->descr,
+					       &rs->child_count, &rs->lookup);
+
+	rs->flags = flags;
+	rs->mask = mask;
+	rs->depth = 0u;
+
+	rs->results = results;
+	rs->results_size = results_size;
+	rs->results_remaining = results_size;
+	rs->buf = buf;
+	rs->size = buf ? buf_size : 0u;
+	rs->strs_len = 0u;
+	rs->leaf = NULL;
+	rs->status = (valid && results) ? 0 : -EINVAL;
+
+	url_stream_init(&rs->url, buf, buf_size, route_stream_cb, rs);
+}
+
+int route_stream_feed(struct route_stream *rs, const char *data, size_t len)
+{
+	if (!rs)
+		return -EINVAL;
+
+	if (rs->status < 0)
+		return rs->status;
+
+	return url_stream_feed(&rs->url, data, len);
+}
+
+int route_stream_end(struct route_stream *rs)
+{
+	if (!rs)
+		return -EINVAL;
+
+	if (rs->status < 0)
+		return rs->status;
+
+	const int ret = url_stream_end(&rs->url);
+
+	return ret ? ret : (rs->status < 0 ? rs->status : 0);
+}
+
+struct route_index_count
+{
+	size_t nodes;
+	size_t sections;
+};
+
+static bool route_index_count_cb(const struct route_descr *descr,
+				 const struct route_descr *parents[],
+				 size_t depth,
+				 void *user_data)
+{
+	struct route_index_count *const c = user_data;
+
+	(void)parents;
+	(void)depth;
+
+	c->nodes++;
+	if (!is_leaf(descr))
+		c->sections++;
+
+	return true;
+}
+
+/* Order static children by name, then by position */
+static int route_index_cmp(const struct route_descr *list,
+			   const struct route_index_ref *a,
+			   const struct route_index_ref *b)
+{
+	const int r = route_name_cmp(&list[a->pos].part, &list[b->pos].part);
+
+	return r ? r : (int)a->pos - (int)b->pos;
+}
+
+static inline uint8_t route_index_byte(const struct route_descr *list,
+				       const struct route_index_ref *ref,
+				       size_t i)
+{
+	return (uint8_t)list[ref->pos].part.str[i];
+}
+
+/* Build node n over refs [lo, hi) (sorted, sharing a prefix of d chars) */
+static int route_index_build_node(struct route_index *idx,
+				  size_t node_cap,
+				  const struct route_descr *list,
+				  uint16_t n,
+				  uint16_t lo,
+				  uint16_t hi,
+				  size_t d)
+{
+	struct route_index_node *const node = &idx->nodes[n];
+	const struct route_part *const first = &list[idx->refs[lo].pos].part;
+	const struct route_part *const last = &list[idx->refs[hi - 1u].pos].part;
+	size_t l = d;
+	uint16_t i, j;
+
+	/* Names are sorted, the common prefix is the one of first and last */
+	while (l < first->len && l < last->len && first->str[l] == last->str[l])
+		l++;
+
+	node->label = &first->str[d];
+	node->len = (uint16_t)(l - d);
+
+	/* Names ending here come first */
+	for (i = lo; i < hi && list[idx->refs[i].pos].part.len == l; i++)
+		;
+
+	node->refs = lo;
+	node->ref_count = i - lo;
+
+	/* Other names are partitioned by their next byte */
+	uint16_t count = 0u;
+	for (j = i; j < hi; j++) {
+		if (j == i || route_index_byte(list, &idx->refs[j], l) !=
+			      route_index_byte(list, &idx->refs[j - 1u], l))
+			count++;
+	}
+
+	if (idx->node_count + count > node_cap)
+		return -ENOMEM;
+
+	node->children = idx->node_count;
+	node->child_count = count;
+	idx->node_count += count;
+
+	for (uint16_t c = node->children; i < hi; i = j, c++) {
+		const uint8_t b = route_index_byte(list, &idx->refs[i], l);
+
+		for (j = i + 1u; j < hi && route_index_byte(list, &idx->refs[j], l) == b; j++)
+			;
+
+		const int ret = route_index_build_node(idx, node_cap, list, c, i, j, l);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int route_index_build_section(struct route_index *idx,
+				     size_t section_cap,
+				     size_t node_cap,
+				     uint16_t s)
+{
+	struct route_index_section *const sec = &idx->sections[s];
+	const struct route_descr *const list = sec->list;
+	const uint16_t base = idx->ref_count;
+	uint16_t ns = 0u;
+
+	/* Static children sorted by name (insertion sort, sections are small) */
+	for (uint16_t pos = 0u; pos < sec->count; pos++) {
+		if (list[pos].flags & ROUTE_ARG_MASK)
+			continue;
+
+		struct route_index_ref *const refs = &idx->refs[base];
+		const struct route_index_ref ref = { .pos = pos };
+		uint16_t k = ns++;
+
+		while (k && route_index_cmp(list, &refs[k - 1u], &ref) > 0) {
+			refs[k] = refs[k - 1u];
+			k--;
+		}
+		refs[k] = ref;
+	}
+
+	/* Then typed children, in section order */
+	sec->typed = base + ns;
+	sec->typed_count = 0u;
+	for (uint16_t pos = 0u; pos < sec->count; pos++) {
+		if (list[pos].flags & ROUTE_ARG_MASK) {
+			idx->refs[sec->typed + sec->typed_count++].pos = pos;
+		}
+	}
+
+	idx->ref_count += sec->count;
+
+	/* Child sections are appended, to be built later */
+	for (uint16_t r = base; r < idx->ref_count; r++) {
+		const struct route_descr *const child = &list[idx->refs[r].pos];
+
+		if (is_leaf(child)) {
+			idx->refs[r].section = ROUTE_INDEX_NONE;
+		} else {
+			if (idx->section_count >= section_cap ||
+			    child->children.count >= ROUTE_INDEX_NONE)
+				return -E2BIG;
+
+			idx->refs[r].section = idx->section_count;
+			idx->sections[idx->section_count++] = (struct route_index_section) {
+				.list = child->children.list,
+				.count = (uint16_t)child->children.count,
+			};
+		}
+	}
+
+	if (!ns) {
+		sec->node = ROUTE_INDEX_NONE;
+		return 0;
+	}
+
+	if (idx->node_count >= node_cap)
+		return -ENOMEM;
+
+	sec->node = idx->node_count++;
+
+	return route_index_build_node(idx, node_cap, list, sec->node,
+				      base, base + ns, 0u);
+}
+
+int route_tree_compile(const struct route_descr *root,
+		       size_t size,
+		       struct route_index *index,
+		       void *buf,
+		       size_t buf_size)
+{
+	int ret;
+	struct route_index_count c = { 0u };
+
+	if (!root || !size || !index)
+		return -EINVAL;
+
+	ret = route_tree_iterate(root, size, route_index_count_cb, &c);
+	if (ret < 0)
+		return ret;
+
+	/* A radix tree over n names has at most 2n nodes, plus its root */
+	const size_t sections = c.sections + 1u;
+	const size_t refs = c.nodes;
+	const size_t nodes = 2u * c.nodes + sections;
+
+	if (nodes >= ROUTE_INDEX_NONE || size >= ROUTE_INDEX_NONE)
+		return -E2BIG;
+
+	const size_t needed = sections * sizeof(struct route_index_section) +
+			      nodes * sizeof(struct route_index_node) +
+			      refs * sizeof(struct route_index_ref);
+
+	if (!buf)
+		return (int)needed;
+
+	if (buf_size < needed)
+		return -ENOMEM;
+
+	index->sections = buf;
+	index->nodes = (struct route_index_node *)&index->sections[sections];
+	index->refs = (struct route_index_ref *)&index->nodes[nodes];
+	index->node_count = 0u;
+	index->ref_count = 0u;
+
+	index->sections[0u] = (struct route_index_section) {
+		.list = root,
+		.count = (uint16_t)size,
+	};
+	index->section_count = 1u;
+
+	/* Sections are built in breadth-first order */
+	for (uint16_t s = 0u; s < index->section_count; s++) {
+		ret = route_index_build_section(index, sections, nodes, s);
+		if (ret)
+			return ret;
+	}
+
+	return (int)needed;
+}
+
+static const struct route_index_node *route_index_lookup(const struct route_index *idx,
+							 uint16_t n,
+							 const struct route_part *p)
+{
+	size_t i = 0u;
+
+	for (;;) {
+		const struct route_index_node *const node = &idx->nodes[n];
+
+		if (node->len > p->len - i || memcmp(node->label, &p->str[i], node->len))
+			return NULL;
+
+		i += node->len;
+		if (i == p->len)
+			return node;
+
+		/* Binary search of the child starting with the next byte */
+		const uint8_t b = (uint8_t)p->str[i];
+		uint16_t lo = node->children;
+		uint16_t hi = node->children + node->child_count;
+
+		for (;;) {
+			if (lo >= hi)
+				return NULL;
+
+			n = lo + (hi - lo) / 2u;
+
+			const uint8_t c = (uint8_t)idx->nodes[n].label[0u];
+			if (c == b)
+				break;
+			else if (c < b)
+				lo = n + 1u;
+			else
+				hi = n;
+		}
+	}
+}
+
+static int route_index_resolve_part(const struct route_index *idx,
+				    uint16_t *s,
+				    const struct route_part *p,
+				    struct route_resolve_context *x)
+{
+	/* Nothing can follow a leaf */
+	if (route_found(x) == true)
+		return -ENOENT;
+
+	if (!x->result)
+		return -ENOMEM;
+
+	const struct route_index_section *const sec = &idx->sections[*s];
+	const struct route_index_node *const node =
+		(sec->node != ROUTE_INDEX_NONE) ? route_index_lookup(idx, sec->node, p) : NULL;
+
+	uint16_t a = node ? node->refs : 0u;
+	const uint16_t a_end = node ? node->refs + node->ref_count : 0u;
+	uint16_t b = sec->typed;
+	const uint16_t b_end = sec->typed + sec->typed_count;
 
-		*(const char **)arg = part->str;
+	/* Candidates are tried in section order */
+	while (a < a_end || b < b_end) {
+		const struct route_index_ref *const r =
+			(b == b_end || (a < a_end && idx->refs[a].pos < idx->refs[b].pos)) ?
+			&idx->refs[a++] : &idx->refs[b++];
+
+		if (route_node_match(&sec->list[r->pos], p, x) == true) {
+			if (r->section != ROUTE_INDEX_NONE)
+				*s = r->section;
+			return 0;
+		}
 	}
 
-	return true;
+	return -ENOENT;
 }
 
-struct resolve_context {
-	/**
-	 * @brief Last descriptor being matched
-	 */
-	const struct route_descr *descr;
+const struct route_descr *route_index_resolve(const struct route_index *index,
+					      const char *url,
+					      size_t len,
+					      uint32_t flags,
+					      uint32_t mask,
+					      struct route_parse_result *results,
+					      size_t *results_count,
+					      const char **query_string)
+{
+	int end;
+	const struct route_descr *leaf = NULL;
 
-	/**
-	 * @brief Children count of the last section being matched
-	 *
-	 * If route has been found, this value is 0. It can be used to know
-	 * whether we expect more parts in the route or not.
-	 */
-	size_t child_count;
+	if (!index || !index->section_count || !url || !results ||
+	    !results_count || !*results_count)
+		goto exit;
 
-	/**
-	 * @brief Current memory block to store matched route part.
-	 *
-	 * Note: Should be initialized to the beginning of an array
-	 */
-	struct route_parse_result *result;
+	struct route_resolve_context x = {
+		.descr = index->sections[0u].list,
+		.child_count = index->sections[0u].count,
+		.result = &results[0u],
+		.results_remaining = *results_count,
+		.flags = flags,
+		.mask = mask,
+		.depth = 0u,
+	};
 
-	/**
-	 * @brief Remaining number of elements
-	 *
-	 * Note: Should be initialized  to the size of the array
-	 */
-	size_t results_remaining;
+	const char *const q = memchr(url, '?', len);
+	struct route_part p;
+	uint16_t s = 0u;
+	bool more;
 
-	/**
-	 * Flags value to match
-	 */
-	uint32_t flags;
+	end = q ? (int)(q - url) : (int)len;
 
-	/**
-	 * @brief Flags mask to match
-	 */
-	uint32_t mask;
+	size_t pos = route_path_start(url, (size_t)end);
 
-	/**
-	 * @brief Depth of the current route
-	 */
-	uint32_t depth;
-};
+	do {
+		more = route_split_next(url, &pos, (size_t)end, &p);
+		if (route_index_resolve_part(index, &s, &p, &x))
+			break;
 
-static inline bool route_found(struct resolve_context *x)
-{
-	return x->child_count == 0u;
+		if (!more)
+			leaf = route_tree_resolve_end(&x, url + end);
+	} while (more);
+
+	if (leaf) {
+		*results_count -= x.results_remaining;
+
+		if (query_string) {
+			*query_string = ((size_t)end < len) ? url + end + 1u : url + len;
+		}
+	} else {
+		*results_count = 0u;
+	}
+
+exit:
+	return leaf;
 }
 
-static inline void mark_route_found(struct resolve_context *x)
+static bool route_packed_parse(const struct route_packed *pk,
+			       uint16_t n,
+			       const struct route_part *p,
+			       struct route_parse_result *res)
 {
-	x->child_count = 0u;
+	const uint16_t fl = pk->flags[n];
+
+	if (fl & ROUTE_ARG_NUMBER)
+		return route_arg_parse(fl, p, res);
+
+	res->part = *p;
+
+	if (fl & ROUTE_ARG_STR)
+		return true;
+
+	return pk->len[n] == p->len && !memcmp(&pk->pool[pk->name[n]], p->str, p->len);
 }
 
-static inline bool node_matches_flags(const struct route_descr *descr,
+static inline bool route_packed_flags(const struct route_packed *pk,
+				      uint16_t n,
 				      uint32_t flags,
 				      uint32_t mask)
 {
-	return (descr->flags & mask) == (flags & mask);
+	return (pk->flags[n] & mask) == (flags & mask);
 }
 
-static int route_tree_resolve_cb(struct route_part *p,
-				 void *user_data)
+int route_packed_resolve(const struct route_packed *pk,
+			 const char *url,
+			 size_t len,
+			 uint32_t flags,
+			 uint32_t mask,
+			 struct route_parse_result *results,
+			 size_t *results_count,
+			 const char **query_string)
 {
-	struct resolve_context *x = user_data;
+	int ret;
 
-	/* If we found the route but there is more, then we return an error
-	 * In order to ignore trailing '/', we just ignore empty parts
-	 */
-	if ((p->len != 0u) && (route_found(x) == true)) {
-		return -ENOENT;
-	}
+	if (!pk || !url || !results || !results_count || !*results_count)
+		return -EINVAL;
 
-	if (!x->result) {
-		return -ENOMEM;
-	}
+	const char *const q = memchr(url, '?', len);
+	const size_t end = q ? (size_t)(q - url) : len;
+	size_t pos = route_path_start(url, end);
+	struct route_part p;
+	bool more = true;
 
-	const struct route_descr *node;
-	for (node = x->descr; node < x->descr + x->child_count; node++) {
-		if (route_part_parse(node, p, &x->result->arg) == true) {
-			bool match = false;
+	uint16_t first = 0u;
+	uint16_t count = pk->root_count;
+	uint32_t depth = 0u;
+	size_t r = 0u;
+	int leaf = -ENOENT;
 
-			if (is_leaf(node)) {
+	while (more) {
+		more = route_split_next(url, &pos, end, &p);
+
+		/* Nothing can follow a leaf */
+		if (leaf >= 0) {
+			ret = -ENOENT;
+			goto exit;
+		}
+
+		if (r >= *results_count) {
+			ret = -ENOMEM;
+			goto exit;
+		}
+
+		uint16_t n;
+		for (n = first; n < first + count; n++) {
+			if (!route_packed_parse(pk, n, &p, &results[r]))
+				continue;
 
+			if (pk->flags[n] & ROUTE_IS_LEAF) {
 				/* Leaf flags should match */
-				if (node_matches_flags(node, x->flags, x->mask)) {
-					x->descr = node;
-					mark_route_found(x);
-					match = true;
-				}
+				if (!route_packed_flags(pk, n, flags, mask))
+					continue;
+
+				leaf = n;
 			} else {
-				/* Prepare context for next call */
-				x->descr = node->children.list;
-				x->child_count = node->children.count;
-				match = true;
+				first = pk->index[n];
+				count = pk->count[n];
 			}
 
+			break;
+		}
+
+		if (n == first + count && leaf != n) {
+			ret = -ENOENT;
+			goto exit;
+		}
 
+		results[r].depth = ++depth;
+		results[r].node = n;
+		results[r].descr = NULL;
+		r++;
+	}
 
-			if (match) {
-				x->result->depth = ++x->depth;
-				x->result->descr = node;
-				x->result = x->results_remaining-- > 0u ? x->result + 1u : NULL;
-				return 0;
+	/* Ending on a section, find its unnamed leaf */
+	if (leaf < 0) {
+		if (r >= *results_count) {
+			ret = -ENOMEM;
+			goto exit;
+		}
+
+		for (uint16_t n = first; n < first + count; n++) {
+			if (!pk->len[n] &&
+			    route_packed_flags(pk, n, flags | ROUTE_IS_LEAF, mask | ROUTE_IS_LEAF)) {
+				results[r].depth = depth + 1u;
+				results[r].node = n;
+				results[r].descr = NULL;
+				results[r].part.str = url + end;
+				results[r].part.len = 0u;
+				r++;
+				leaf = n;
+				break;
 			}
 		}
+
+		if (leaf < 0) {
+			ret = -ENOENT;
+			goto exit;
+		}
 	}
 
-	return -ENOENT;
+	*results_count = r;
+
+	if (query_string) {
+		*query_string = (end < len) ? url + end + 1u : url + len;
+	}
+
+	return leaf;
+
+exit:
+	*results_count = 0u;
+	return ret;
 }
 
-static const struct route_descr *
-find_section_leaf(const struct route_descr *section_first_child,
-		  size_t count,
-		  uint32_t flags,
-		  uint32_t mask)
+void route_packed_descr(const struct route_packed *pk,
+			uint16_t node,
+			struct route_descr *descr)
 {
-	const struct route_descr *leaf = NULL;
+	const struct route_packed_leaf *const leaf = route_packed_leaf(pk, node);
 
-	/* Search for leaf */
-	flags |= ROUTE_IS_LEAF;
-	mask |= ROUTE_IS_LEAF;
+	descr->flags = pk->flags[node];
+	descr->part.str = &pk->pool[pk->name[node]];
+	descr->part.len = pk->len[node];
 
-	for (const struct route_descr *node = section_first_child;
-	     node < section_first_child + count;
-	     node++) {
-		/* Find unamed leaf which matches flags */
-		if (!node->part.len && node_matches_flags(node, flags, mask)) {
-			leaf = node;
-			break;
-		}
+	if (leaf) {
+		descr->resp_handler = leaf->resp_handler;
+		descr->req_handler = leaf->req_handler;
+		descr->query = leaf->query;
+		descr->user_data = leaf->user_data;
+	} else {
+		descr->children.list = NULL;
+		descr->children.count = pk->count[node];
+		descr->children.lookup = NULL;
+		descr->user_data = pk->user_data ? pk->user_data[node] : 0u;
 	}
+}
 
-	return leaf;
+void route_packed_expand(const struct route_packed *pk,
+			 struct route_parse_result *results,
+			 size_t count,
+			 struct route_descr descrs[])
+{
+	for (size_t i = 0u; i < count; i++) {
+		route_packed_descr(pk, results[i].node, &descrs[i]);
+		results[i].descr = &descrs[i];
+	}
 }
 
-const struct route_descr *route_tree_resolve(const struct route_descr *root,
-					     size_t size,
-					     char *url,
-					     uint32_t flags,
-					     uint32_t mask,
-					     struct route_parse_result *results,
-					     size_t *results_count,
-					     char **query_string)
+#if defined(CONFIG_EMBEDC_URL_PARSER_MATCHER)
+
+int route_match_init(struct route_match *m,
+		     const char *url,
+		     size_t len,
+		     uint32_t flags,
+		     uint32_t mask,
+		     struct route_parse_result *results,
+		     size_t count)
 {
-	int ret;
-	const struct route_descr *leaf = NULL;
+	if (!m || !url || !results || !count)
+		return -EINVAL;
 
-	if (!root || !size || !url || !results || !results_count || !*results_count)
-		goto exit;
+	const char *const q = memchr(url, '?', len);
 
-	struct resolve_context x = {
-		.descr = root,
-		.child_count = size,
-		.result = &results[0u],
-		.results_remaining = *results_count,
-		.flags = flags,
-		.mask = mask,
-		.depth = 0u,
-	};
+	m->url = url;
+	m->len = len;
+	m->end = q ? (size_t)(q - url) : len;
+	m->pos = 0u;
+	m->more = true;
+	m->result = &results[0u];
+	m->remaining = count;
+	m->depth = 0u;
+	m->flags = flags;
+	m->mask = mask;
 
-	ret = route_parse(url, route_tree_resolve_cb, &x);
+	/* Remove leading '/' */
+	while (m->pos < m->end && url[m->pos] == '/')
+		m->pos++;
 
-	if ((ret >= 0) && x.descr) {
-		if (is_leaf(x.descr) && route_found(&x)) {
-			leaf = x.descr;
-		} else {
-			/**
-			 * @brief If we end up on a section, we need to find the
-			 * unamed leaf which matches the flags.
-			 */
-			leaf = find_section_leaf(x.descr, x.child_count, flags, mask);
-			if (!x.result) {
-				leaf = NULL;
-			} else if (leaf) {
-				x.result->depth = x.depth + 1u;
-				x.result->descr = leaf;
-				x.result->str = url + (uint32_t)ret - 1u;
-				x.results_remaining--;
-			}
-		}
-	}
+	return 0;
+}
+
+bool route_match_next(struct route_match *m)
+{
+	if (!m->more || !m->result)
+		return false;
+
+	const size_t slash = route_slash_next(m->url, m->pos, m->end);
+
+	m->part.str = &m->url[m->pos];
+	m->part.len = slash - m->pos;
+	m->result->part = m->part;
+
+	m->more = slash != m->end;
+	m->pos = slash + 1u;
+
+	return true;
+}
+
+bool route_match_uint(struct route_match *m)
+{
+	return uint_parse(m->part.str, m->part.len, &m->result->uint);
+}
+
+bool route_match_hex(struct route_match *m)
+{
+	return hex_parse(m->part.str, m->part.len, &m->result->uint);
+}
 
+bool route_match_number(struct route_match *m, uint32_t flags)
+{
+	return route_arg_parse(flags, &m->part, m->result);
+}
+
+const struct route_descr *route_match_finish(struct route_match *m,
+					     const struct route_descr *leaf,
+					     size_t *results_count,
+					     const char **query_string)
+{
 	if (leaf) {
-		*results_count -= x.results_remaining;
+		*results_count -= m->remaining;
 
-		/* ret necessarily positive at this point */
 		if (query_string) {
-			*query_string = url + (uint32_t)ret;
+			*query_string = (m->end < m->len) ? m->url + m->end + 1u : m->url + m->len;
 		}
 	} else {
 		*results_count = 0u;
 	}
 
-exit:
 	return leaf;
 }
 
+#endif /* CONFIG_EMBEDC_URL_PARSER_MATCHER */
+
 int route_build_url(char *url,
 		    size_t url_size,
 		    const struct route_descr **parents,
@@ -520,6 +3167,86 @@ int route_results_get_arg_by_index(const struct route_parse_result *results,
 	return result_get_arg(&results[index], arg_flags, arg);
 }
 
+static int result_get_value(const struct route_parse_result *res,
+			    uint32_t arg_flags,
+			    uint64_t *value)
+{
+	if (!res->descr)
+		return -EINVAL;
+
+	const uint32_t flags = res->descr->flags;
+
+	if (!(flags & arg_flags & ROUTE_ARG_NUMBER))
+		return -EINVAL;
+
+	/* Not truncated to the 32-bit value of a 64-bit argument */
+	if ((flags & ROUTE_ARG_64) && !(arg_flags & ROUTE_ARG_64))
+		return -EINVAL;
+
+	if (flags & ROUTE_ARG_64)
+		*value = res->uint64;
+	else if (flags & ROUTE_ARG_INT)
+		*value = (uint64_t)(int64_t)res->sint;
+	else
+		*value = res->uint;
+
+	return 0;
+}
+
+int route_results_find_value(const struct route_parse_result *results,
+			     size_t count,
+			     const struct route_descr *search,
+			     uint32_t arg_flags,
+			     uint64_t *value)
+{
+	if (!results || !count || !value)
+		return -EINVAL;
+
+	for (size_t i = 0u; i < count; i++) {
+		if (results[i].descr == search)
+			return result_get_value(&results[i], arg_flags, value);
+	}
+
+	return -ENOENT;
+}
+
+int route_results_get_value_by_index(const struct route_parse_result *results,
+				     size_t count,
+				     uint32_t index,
+				     uint32_t arg_flags,
+				     uint64_t *value)
+{
+	if (!results || !count || !value)
+		return -EINVAL;
+
+	if (index >= count)
+		return -ENOENT;
+
+	return result_get_value(&results[index], arg_flags, value);
+}
+
+/* Typed part named name (e.g. "id" for "id:u"), with one of arg_flags */
+static bool result_name_match(const char *str,
+			      size_t len,
+			      uint32_t flags,
+			      const char *name,
+			      uint32_t arg_flags)
+{
+	if ((flags & arg_flags) == 0u)
+		return false;
+
+	/* Ignore trailing type (e.g. :u) in comparison */
+	const char *const type = memchr(str, ':', len);
+	if (!type)
+		return false;
+
+	const size_t name_len = strlen(name);
+	if (name_len != (size_t)(type - str))
+		return false;
+
+	return strncmp(name, str, name_len) == 0;
+}
+
 int
 route_results_get(const struct route_parse_result *results,
 		  size_t count,
@@ -533,16 +3260,42 @@ route_results_get(const struct route_parse_result *results,
 	arg_flags &= ROUTE_ARG_MASK;
 
 	for (size_t i = 0u; i < count; i++) {
-		if ((results[i].descr->flags & arg_flags) == 0u) {
+		const struct route_descr *const descr = results[i].descr;
+
+		/* No descriptor in packed results */
+		if (!descr)
 			continue;
+
+		if (result_name_match(descr->part.str, descr->part.len, descr->flags,
+				      name, arg_flags)) {
+			*arg = (void *)results[i].arg;
+			return 0;
 		}
+	}
+
+	return -ENOENT;
+}
 
-		size_t name_len = strlen(name);
-		if (name_len != results[i].descr->part.len - 2u) { /* Ignore trailling :u in comparison */
+int route_packed_results_get(const struct route_packed *pk,
+			     const struct route_parse_result *results,
+			     size_t count,
+			     const char *name,
+			     uint32_t arg_flags,
+			     void **arg)
+{
+	if (!pk || !results || !count || !name || !arg || !arg_flags)
+		return -EINVAL;
+
+	arg_flags &= ROUTE_ARG_MASK;
+
+	for (size_t i = 0u; i < count; i++) {
+		const uint16_t n = results[i].node;
+
+		if (n >= pk->node_count)
 			continue;
-		}
 
-		if (strncmp(name, results[i].descr->part.str, name_len) == 0) {
+		if (result_name_match(&pk->pool[pk->name[n]], pk->len[n], pk->flags[n],
+				      name, arg_flags)) {
 			*arg = (void *)results[i].arg;
 			return 0;
 		}
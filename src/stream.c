@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "classify.h"
+
+/* Return index of the first delimiter of the current state from data[i],
+ * len if none.
+ */
+static size_t url_stream_find(const struct url_stream *s,
+			      const char *data,
+			      size_t i,
+			      size_t len)
+{
+	const char a = (s->state == URL_STREAM_STATE_PATH) ? '/' : '&';
+	const char b = (s->state == URL_STREAM_STATE_PATH) ? '?' : '=';
+
+	for (; i + CLASSIFY_BLOCK <= len; i += CLASSIFY_BLOCK) {
+		classify_mask_t m = classify_block(&data[i], a, b, ' ');
+		if (m)
+			return i + classify_next(&m);
+	}
+
+	while (i < len && data[i] != a && data[i] != b && data[i] != ' ')
+		i++;
+
+	return i;
+}
+
+static int url_stream_carry(struct url_stream *s, const char *data, size_t n)
+{
+	if (n > s->size - s->len)
+		return -ENOMEM;
+
+	memcpy(&s->buf[s->len], data, n);
+	s->len += n;
+
+	return 0;
+}
+
+/* Report the current token, made of the carried bytes followed by the
+ * n bytes at data.
+ */
+static int url_stream_emit(struct url_stream *s, const char *data, size_t n)
+{
+	int ret;
+	const char *tok = data;
+	size_t tlen = n;
+
+	if (s->len) {
+		ret = url_stream_carry(s, data, n);
+		if (ret)
+			return ret;
+
+		tok = s->buf;
+		tlen = s->len;
+	}
+
+	struct url_stream_token t = {
+		.key = tok,
+		.key_len = tlen,
+		.value = NULL,
+		.value_len = 0u,
+	};
+	enum url_stream_event event = URL_STREAM_SEGMENT;
+
+	if (s->state == URL_STREAM_STATE_QUERY) {
+		event = URL_STREAM_QUERY_ARG;
+		if (s->has_value) {
+			t.key_len = s->key_len;
+			t.value = tok + s->value_off;
+			t.value_len = tlen - s->value_off;
+		}
+	}
+
+	s->len = 0u;
+	s->has_value = false;
+
+	/* Ignore arguments with an empty key */
+	if (event == URL_STREAM_QUERY_ARG && !t.key_len)
+		return 0;
+
+	return s->cb(event, &t, s->user_data);
+}
+
+static int url_stream_finish(struct url_stream *s, const char *data, size_t n)
+{
+	if (s->state == URL_STREAM_STATE_LEADING)
+		s->state = URL_STREAM_STATE_PATH;
+
+	const bool path = (s->state == URL_STREAM_STATE_PATH);
+	int ret = url_stream_emit(s, data, n);
+
+	if (!ret && path)
+		ret = s->cb(URL_STREAM_PATH_END, NULL, s->user_data);
+
+	s->state = URL_STREAM_STATE_DONE;
+
+	if (!ret)
+		ret = s->cb(URL_STREAM_END, NULL, s->user_data);
+
+	return ret;
+}
+
+void url_stream_init(struct url_stream *s,
+		     char *buf,
+		     size_t size,
+		     url_stream_cb_t cb,
+		     void *user_data)
+{
+	s->state = URL_STREAM_STATE_LEADING;
+	s->has_value = false;
+	s->key_len = 0u;
+	s->value_off = 0u;
+	s->buf = buf;
+	s->size = buf ? size : 0u;
+	s->len = 0u;
+	s->cb = cb;
+	s->user_data = user_data;
+}
+
+int url_stream_feed(struct url_stream *s, const char *data, size_t len)
+{
+	if (!s || !s->cb || (!data && len))
+		return -EINVAL;
+
+	int ret;
+	size_t i = 0u;
+
+	if (s->state == URL_STREAM_STATE_LEADING) {
+		/* Remove leading '/' */
+		while (i < len && data[i] == '/')
+			i++;
+
+		if (i < len)
+			s->state = URL_STREAM_STATE_PATH;
+	}
+
+	size_t tok = i;
+
+	while (s->state != URL_STREAM_STATE_DONE && i < len) {
+		const size_t d = url_stream_find(s, data, i, len);
+		if (d == len) {
+			i = len;
+			break;
+		}
+
+		const char c = data[d];
+		i = d + 1u;
+
+		if (c == '=') {
+			/* Key ends at the first '=', later ones belong to the
+			 * value, as with the buffered parsers
+			 */
+			if (!s->has_value) {
+				s->key_len = s->len + (d - tok);
+				s->value_off = s->key_len + 1u;
+				s->has_value = true;
+			}
+			continue;
+		}
+
+		if (c == ' ') {
+			ret = url_stream_finish(s, &data[tok], d - tok);
+			return ret ? ret : (int)i;
+		}
+
+		ret = url_stream_emit(s, &data[tok], d - tok);
+		if (ret)
+			return ret;
+
+		if (c == '?') {
+			s->state = URL_STREAM_STATE_QUERY;
+
+			ret = s->cb(URL_STREAM_PATH_END, NULL, s->user_data);
+			if (ret)
+				return ret;
+		}
+
+		tok = i;
+	}
+
+	/* Keep incomplete token for next chunk */
+	if (s->state != URL_STREAM_STATE_DONE) {
+		ret = url_stream_carry(s, &data[tok], len - tok);
+		if (ret)
+			return ret;
+	}
+
+	return (int)i;
+}
+
+int url_stream_end(struct url_stream *s)
+{
+	if (!s || !s->cb)
+		return -EINVAL;
+
+	if (s->state == URL_STREAM_STATE_DONE)
+		return 0;
+
+	/* Last token is made of the carried bytes only */
+	return url_stream_finish(s, "", 0u);
+}
+
+static inline bool is_hex(char c)
+{
+	return (c >= '0' && c <= '9') ||
+	       ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+static size_t form_stream_find(const struct form_stream *s,
+			       const char *data,
+			       size_t i,
+			       size_t len)
+{
+	const char b = (s->state == FORM_STREAM_STATE_KEY) ? '=' : '&';
+
+	for (; i + CLASSIFY_BLOCK <= len; i += CLASSIFY_BLOCK) {
+		classify_mask_t m = classify_block(&data[i], '&', b, '&');
+		if (m)
+			return i + classify_next(&m);
+	}
+
+	while (i < len && data[i] != '&' && data[i] != b)
+		i++;
+
+	return i;
+}
+
+static void form_stream_reset(struct form_stream *s)
+{
+	s->state = FORM_STREAM_STATE_KEY;
+	s->skip = false;
+	s->len = 0u;
+	s->key_len = 0u;
+}
+
+/* Append key bytes, one byte is kept for in place decoding */
+static int form_stream_key_append(struct form_stream *s, const char *data, size_t n)
+{
+	if (n >= s->size - s->len)
+		return -ENOMEM;
+
+	memcpy(&s->buf[s->len], data, n);
+	s->len += n;
+
+	return 0;
+}
+
+static int form_stream_key_end(struct form_stream *s)
+{
+	int ret = query_value_decode(s->buf, s->len, s->buf, s->size);
+	if (ret < 0)
+		return ret;
+
+	s->key_len = s->len = (size_t)ret;
+
+	return 0;
+}
+
+static int form_stream_value(struct form_stream *s,
+			     const char *value,
+			     size_t n,
+			     bool complete)
+{
+	if (s->skip)
+		return 0;
+
+	const struct url_stream_token t = {
+		.key = s->buf,
+		.key_len = s->key_len,
+		.value = value,
+		.value_len = n,
+	};
+
+	return s->cb(&t, complete, s->user_data);
+}
+
+/* Report held back bytes of the value, if any */
+static int form_stream_value_held(struct form_stream *s, bool complete)
+{
+	int ret = 0;
+
+	if (s->len > s->key_len || complete) {
+		ret = form_stream_value(s, &s->buf[s->key_len],
+					s->len - s->key_len, complete);
+		s->len = s->key_len;
+	}
+
+	return ret;
+}
+
+void form_stream_init(struct form_stream *s,
+		      char *buf,
+		      size_t size,
+		      form_stream_cb_t cb,
+		      void *user_data)
+{
+	s->buf = buf;
+	s->size = buf ? size : 0u;
+	s->cb = cb;
+	s->user_data = user_data;
+
+	form_stream_reset(s);
+}
+
+int form_stream_feed(struct form_stream *s, const char *data, size_t len)
+{
+	if (!s || !s->cb || (!data && len))
+		return -EINVAL;
+
+	int ret;
+	size_t i = 0u;
+
+	/* Complete the percent-escape held back from previous chunk,
+	 * report it as soon as it is complete or known to be invalid
+	 */
+	if (s->state == FORM_STREAM_STATE_VALUE && s->len > s->key_len) {
+		while (s->len - s->key_len < 3u && i < len && is_hex(data[i]))
+			s->buf[s->len++] = data[i++];
+
+		if (s->len - s->key_len == 3u || i < len) {
+			ret = form_stream_value_held(s, false);
+			if (ret)
+				return ret;
+		}
+	}
+
+	size_t tok = i;
+
+	while (i < len) {
+		const size_t d = form_stream_find(s, data, i, len);
+		if (d == len)
+			break;
+
+		const char c = data[d];
+		i = d + 1u;
+
+		if (s->state == FORM_STREAM_STATE_KEY) {
+			ret = form_stream_key_append(s, &data[tok], d - tok);
+			if (!ret)
+				ret = form_stream_key_end(s);
+			if (ret)
+				return ret;
+
+			if (c == '=') {
+				/* Room for held back escape bytes */
+				if (s->key_len + 3u > s->size)
+					return -ENOMEM;
+
+				s->state = FORM_STREAM_STATE_VALUE;
+				s->skip = (s->key_len == 0u);
+			} else {
+				if (s->key_len) {
+					const struct url_stream_token t = {
+						.key = s->buf,
+						.key_len = s->key_len,
+						.value = NULL,
+						.value_len = 0u,
+					};
+
+					ret = s->cb(&t, true, s->user_data);
+					if (ret)
+						return ret;
+				}
+				form_stream_reset(s);
+			}
+		} else {
+			if (d > tok) {
+				ret = form_stream_value_held(s, false);
+				if (!ret)
+					ret = form_stream_value(s, &data[tok], d - tok, true);
+			} else {
+				ret = form_stream_value_held(s, true);
+			}
+			if (ret)
+				return ret;
+
+			form_stream_reset(s);
+		}
+
+		tok = i;
+	}
+
+	if (s->state == FORM_STREAM_STATE_KEY) {
+		ret = form_stream_key_append(s, &data[tok], len - tok);
+		if (ret)
+			return ret;
+	} else if (len > tok) {
+		/* Hold back an incomplete percent-escape */
+		size_t n = len - tok;
+		size_t held = 0u;
+
+		if (data[len - 1u] == '%') {
+			held = 1u;
+		} else if (n >= 2u && data[len - 2u] == '%' && is_hex(data[len - 1u])) {
+			held = 2u;
+		}
+
+		if (n > held) {
+			ret = form_stream_value_held(s, false);
+			if (!ret)
+				ret = form_stream_value(s, &data[tok], n - held, false);
+			if (ret)
+				return ret;
+		}
+
+		memcpy(&s->buf[s->len], &data[len - held], held);
+		s->len += held;
+	}
+
+	return (int)len;
+}
+
+int form_stream_end(struct form_stream *s)
+{
+	if (!s || !s->cb)
+		return -EINVAL;
+
+	int ret = 0;
+
+	if (s->state == FORM_STREAM_STATE_VALUE) {
+		ret = form_stream_value_held(s, true);
+	} else if (s->len) {
+		ret = form_stream_key_end(s);
+		if (!ret && s->key_len) {
+			const struct url_stream_token t = {
+				.key = s->buf,
+				.key_len = s->key_len,
+				.value = NULL,
+				.value_len = 0u,
+			};
+
+			ret = s->cb(&t, true, s->user_data);
+		}
+	}
+
+	form_stream_reset(s);
+
+	return ret;
+}
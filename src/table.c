@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+#include <embedc-url/table.h>
+
+/* Whether epoch a is before b, epochs wrap around */
+static inline bool route_epoch_before(unsigned int a, unsigned int b)
+{
+	return (int32_t)((uint32_t)a - (uint32_t)b) < 0;
+}
+
+int route_table_init(struct route_table *table,
+		     struct route_table_reader readers[],
+		     size_t reader_count,
+		     struct route_table_version *version)
+{
+	if (!table || !readers || !reader_count || !version)
+		return -EINVAL;
+
+	for (size_t i = 0u; i < reader_count; i++)
+		atomic_init(&readers[i].epoch, ROUTE_TABLE_EPOCH_IDLE);
+
+	table->generation = 1u;
+	version->generation = table->generation;
+
+	atomic_init(&table->current, version);
+	atomic_init(&table->epoch, 1u);
+
+	table->readers = readers;
+	table->reader_count = reader_count;
+	table->retired = NULL;
+
+	return 0;
+}
+
+const struct route_table_version *route_table_read_lock(struct route_table *table,
+							struct route_table_reader *reader)
+{
+	const unsigned int epoch = atomic_load_explicit(&table->epoch, memory_order_acquire);
+
+	atomic_store_explicit(&reader->epoch, epoch, memory_order_relaxed);
+
+	/* Announced epoch is visible to the writer before the tree is read:
+	 * either the writer sees this reader, or the reader gets the tree
+	 * published before the writer checks.
+	 */
+	atomic_thread_fence(memory_order_seq_cst);
+
+	return atomic_load_explicit(&table->current, memory_order_acquire);
+}
+
+int route_table_publish(struct route_table *table,
+			struct route_table_version *version)
+{
+	if (!table || !version)
+		return -EINVAL;
+
+	/* 0 is left to versions never published */
+	table->generation++;
+	if (!table->generation)
+		table->generation = 1u;
+	version->generation = table->generation;
+
+	struct route_table_version *const old =
+		atomic_exchange_explicit(&table->current, version, memory_order_seq_cst);
+
+	/* Readers entering from the next epoch get the new version, writers
+	 * are serialized so the epoch is only written here
+	 */
+	const unsigned int epoch = atomic_load_explicit(&table->epoch, memory_order_relaxed);
+	unsigned int next = epoch + 1u;
+
+	if (next == ROUTE_TABLE_EPOCH_IDLE)
+		next++;
+
+	atomic_store_explicit(&table->epoch, next, memory_order_seq_cst);
+
+	old->retire_epoch = epoch;
+	old->next = table->retired;
+	table->retired = old;
+
+	return route_table_reclaim(table);
+}
+
+int route_table_reclaim(struct route_table *table)
+{
+	int pending = 0;
+
+	if (!table)
+		return -EINVAL;
+
+	atomic_thread_fence(memory_order_seq_cst);
+
+	/* Readers can't be ahead of the table */
+	unsigned int oldest = atomic_load_explicit(&table->epoch, memory_order_relaxed);
+
+	for (size_t i = 0u; i < table->reader_count; i++) {
+		const unsigned int epoch =
+			atomic_load_explicit(&table->readers[i].epoch, memory_order_acquire);
+
+		if (epoch != ROUTE_TABLE_EPOCH_IDLE && route_epoch_before(epoch, oldest))
+			oldest = epoch;
+	}
+
+	/* A version retired at epoch E can only be read by sections
+	 * which started at epoch E or before.
+	 */
+	struct route_table_version **link = &table->retired;
+	while (*link) {
+		struct route_table_version *const version = *link;
+
+		if (route_epoch_before(version->retire_epoch, oldest)) {
+			*link = version->next;
+			if (version->release)
+				version->release(version);
+		} else {
+			link = &version->next;
+			pending++;
+		}
+	}
+
+	return pending;
+}
@@ -0,0 +1,17 @@
+#ifndef _ROUTES_GEN_H_
+#define _ROUTES_GEN_H_
+
+#include <stddef.h>
+#include <embedc-url/parser.h>
+
+/* samples/routes.txt generated at build time, see CMakeLists.txt */
+
+/* genroutes.py --lookup=jump */
+extern const struct route_descr *const routes_jump_root;
+extern const size_t routes_jump_root_size;
+extern const struct route_descr *const routes_jump_root_section;
+
+/* genroutes.py --packed=routes_packed */
+extern const struct route_packed routes_packed;
+
+#endif /* _ROUTES_GEN_H_ */
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _EMBEDC_URL_TEST_H_
+#define _EMBEDC_URL_TEST_H_
+
+#include <stdio.h>
+
+static int test_failures;
+
+#define TEST_ASSERT(_cond) \
+	do { \
+		if (!(_cond)) { \
+			printf("%s:%d: assertion failed: %s\n", \
+			       __FILE__, __LINE__, #_cond); \
+			test_failures++; \
+		} \
+	} while (0)
+
+/* Exit code of the test program */
+#define TEST_RESULT() (test_failures ? 1 : 0)
+
+#endif /* _EMBEDC_URL_TEST_H_ */
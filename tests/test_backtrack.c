@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "test.h"
+
+/* Within CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS with the last segment */
+#define LEVELS 14u
+#define FANOUT 4u
+
+static void handler(void)
+{
+}
+
+/* Each level has a static and typed sections all sharing the next level as
+ * children: without remembering failed lists, a dead end at the last level
+ * is reached FANOUT^LEVELS times.
+ */
+static struct route_descr levels[LEVELS][FANOUT];
+
+static const struct route_descr leaves[] = {
+	LEAF("end", GET, handler, NULL, 0u),
+	LEAF("end2", GET, handler, NULL, 0u),
+};
+
+static void dag_init(void)
+{
+	for (size_t i = 0u; i < LEVELS; i++) {
+		for (size_t j = 0u; j < FANOUT; j++) {
+			struct route_descr *const d = &levels[i][j];
+
+			d->flags = j ? ARG_STR : 0u;
+			d->part.str = j ? ":s" : "a";
+			d->part.len = j ? 2u : 1u;
+			d->children.list = (i + 1u < LEVELS) ? levels[i + 1u] : leaves;
+			d->children.count = (i + 1u < LEVELS) ? FANOUT : ARRAY_SIZE(leaves);
+		}
+	}
+}
+
+static const char *dag_url(const char *last)
+{
+	static char url[2u * LEVELS + 16u];
+	char *p = url;
+
+	for (size_t i = 0u; i < LEVELS; i++) {
+		*p++ = '/';
+		*p++ = 'a';
+	}
+	*p++ = '/';
+	strcpy(p, last);
+
+	return url;
+}
+
+/* Shared children lists must be walked once per segment, the test times
+ * out otherwise
+ */
+static void test_backtrack_dag(void)
+{
+	struct route_parse_result results[LEVELS + 2u];
+	const char *url;
+	size_t count;
+
+	url = dag_url("nope");
+	count = ARRAY_SIZE(results);
+	TEST_ASSERT(route_tree_resolve_backtrack(levels[0u], FANOUT, url, strlen(url),
+						 GET, METHODS_MASK, results, &count,
+						 NULL) == NULL);
+	TEST_ASSERT(count == 0u);
+
+	url = dag_url("end2");
+	count = ARRAY_SIZE(results);
+	TEST_ASSERT(route_tree_resolve_backtrack(levels[0u], FANOUT, url, strlen(url),
+						 GET, METHODS_MASK, results, &count,
+						 NULL) == &leaves[1u]);
+	TEST_ASSERT(count == LEVELS + 1u);
+}
+
+int main(void)
+{
+	dag_init();
+
+	test_backtrack_dag();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "test.h"
+
+static _Alignas(void *) unsigned char arena[16384u];
+
+static void first(void)
+{
+}
+
+static void second(void)
+{
+}
+
+static const struct route_descr *resolve(const struct route_descr *root,
+					 size_t size,
+					 const char *url,
+					 uint32_t method,
+					 struct route_parse_result *results,
+					 size_t *count)
+{
+	*count = 16u;
+
+	return route_tree_resolve_const(root, size, url, strlen(url), method,
+					METHODS_MASK, results, count, NULL);
+}
+
+/* Routes are merged when the tree is built, whatever their order */
+static void test_builder_merge(void)
+{
+	struct route_tree_builder b;
+	struct route_parse_result results[16u];
+	const struct route_descr *root, *leaf;
+	size_t size, count;
+
+	TEST_ASSERT(route_tree_builder_init(&b, arena, sizeof(arena)) == 0);
+
+	/* Leaf then section, and section then leaf */
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /info", first, NULL, 1u) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /info/version", first, NULL, 2u) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /dev/:u/name", first, NULL, 3u) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "POST /dev/:u", first, NULL, 4u) == 0);
+
+	/* Duplicates are ignored, the first one is kept */
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /info", second, NULL, 5u) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /info/version/", second, NULL, 6u) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "PUT /info", second, NULL, 7u) == 0);
+
+	/* Typed groups in order of first registration */
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /num/:x", first, NULL, 8u) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /num/:u", second, NULL, 9u) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "POST /num/:x", second, NULL, 10u) == 0);
+
+	TEST_ASSERT(route_tree_builder_finish(&b, &root, &size) == 0);
+	TEST_ASSERT(size == 3u);
+
+	leaf = resolve(root, size, "/info", GET, results, &count);
+	TEST_ASSERT(leaf && leaf->resp_handler == first && leaf->user_data == 1u);
+	TEST_ASSERT(count == 2u);
+
+	leaf = resolve(root, size, "/info", PUT, results, &count);
+	TEST_ASSERT(leaf && leaf->resp_handler == second);
+
+	leaf = resolve(root, size, "/info/version", GET, results, &count);
+	TEST_ASSERT(leaf && leaf->resp_handler == first && leaf->user_data == 2u);
+
+	leaf = resolve(root, size, "/dev/12/name", GET, results, &count);
+	TEST_ASSERT(leaf && leaf->user_data == 3u && results[1u].uint == 12u);
+
+	leaf = resolve(root, size, "/dev/12", POST, results, &count);
+	TEST_ASSERT(leaf && leaf->user_data == 4u && results[1u].uint == 12u);
+	TEST_ASSERT(leaf && !(leaf->flags & ROUTE_ARG_MASK));
+
+	leaf = resolve(root, size, "/num/12", GET, results, &count);
+	TEST_ASSERT(leaf && leaf->user_data == 8u && results[1u].uint == 0x12u);
+
+	leaf = resolve(root, size, "/num/12", POST, results, &count);
+	TEST_ASSERT(leaf && leaf->user_data == 10u);
+}
+
+/* A route which doesn't fit leaves the builder unchanged */
+static void test_builder_full(void)
+{
+	static _Alignas(void *) unsigned char small[512u];
+	struct route_tree_builder b;
+	struct route_parse_result results[16u];
+	const struct route_descr *root;
+	size_t size, count;
+
+	TEST_ASSERT(route_tree_builder_init(&b, small, sizeof(small)) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /a", first, NULL, 0u) == 0);
+
+	const size_t used = b.used;
+	TEST_ASSERT(route_tree_builder_add(&b, "GET /a/b/c/d/e/f/g/h/i/j/k/l", first,
+					   NULL, 0u) == -ENOMEM);
+	TEST_ASSERT(b.used == used);
+	TEST_ASSERT(b.root.child_count == 1u);
+
+	TEST_ASSERT(route_tree_builder_finish(&b, &root, &size) == 0);
+	TEST_ASSERT(resolve(root, size, "/a", GET, results, &count) != NULL);
+	TEST_ASSERT(resolve(root, size, "/a/b", GET, results, &count) == NULL);
+}
+
+static const char *const finish_routes[] = {
+	"GET /a/b", "POST /a/b", "GET /a/c", "GET /a/:u", "PUT /d", "GET /a/b",
+};
+
+/* An arena running out while the tree is emitted leaves a usable builder,
+ * whatever its size
+ */
+static void test_builder_finish_full(void)
+{
+	static _Alignas(void *) unsigned char small[4096u];
+	struct route_tree_builder b;
+	struct route_parse_result results[16u];
+	const struct route_descr *root;
+	size_t size, count;
+	bool built = false;
+
+	for (size_t len = 256u; len <= sizeof(small); len += 8u) {
+		int ret;
+
+		TEST_ASSERT(route_tree_builder_init(&b, small, len) == 0);
+
+		ret = 0;
+		for (size_t i = 0u; i < ARRAY_SIZE(finish_routes) && !ret; i++)
+			ret = route_tree_builder_add(&b, finish_routes[i], first, NULL, 0u);
+		if (ret) {
+			TEST_ASSERT(ret == -ENOMEM);
+			continue;
+		}
+
+		ret = route_tree_builder_finish(&b, &root, &size);
+		if (ret) {
+			TEST_ASSERT(ret == -ENOMEM);
+			TEST_ASSERT(b.root.child_count == 2u);
+
+			/* Added to the merged routes, then built again */
+			ret = route_tree_builder_add(&b, "GET /e", second, NULL, 0u);
+			TEST_ASSERT(ret == 0 || ret == -ENOMEM);
+			if (!ret)
+				TEST_ASSERT(b.root.child_count == 3u);
+
+			ret = route_tree_builder_finish(&b, &root, &size);
+			TEST_ASSERT(ret == 0 || ret == -ENOMEM);
+			if (ret)
+				continue;
+		}
+
+		built = true;
+
+		TEST_ASSERT(resolve(root, size, "/a/b", POST, results, &count) != NULL);
+		TEST_ASSERT(resolve(root, size, "/a/12", GET, results, &count) != NULL);
+		TEST_ASSERT(resolve(root, size, "/d", PUT, results, &count) != NULL);
+	}
+
+	TEST_ASSERT(built);
+}
+
+/* Routes are not bounded by CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS */
+static void test_builder_deep(void)
+{
+	struct route_tree_builder b;
+	struct route_parse_result results[32u];
+	const struct route_descr *root;
+	size_t size, count;
+	char route[96u] = "GET ";
+
+	for (size_t i = 0u; i < 24u; i++)
+		strcat(route, "/s");
+
+	TEST_ASSERT(route_tree_builder_init(&b, arena, sizeof(arena)) == 0);
+	TEST_ASSERT(route_tree_builder_add(&b, route, first, NULL, 0u) == 0);
+	TEST_ASSERT(route_tree_builder_finish(&b, &root, &size) == 0);
+
+	count = ARRAY_SIZE(results);
+	TEST_ASSERT(route_tree_resolve_const(root, size, &route[4u], strlen(&route[4u]),
+					     GET, METHODS_MASK, results, &count,
+					     NULL) != NULL);
+	TEST_ASSERT(count == 24u);
+}
+
+int main(void)
+{
+	test_builder_merge();
+	test_builder_full();
+	test_builder_finish_full();
+	test_builder_deep();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+#include <embedc-url/table.h>
+
+#include "test.h"
+
+static void handler(void)
+{
+}
+
+static const struct route_descr other[] = {
+	LEAF("other", GET, handler, NULL, 0u),
+};
+
+/* Tree rebuilt in place, as in an arena reused by a builder */
+static struct route_descr tree[1u];
+
+static void tree_set(const char *name)
+{
+	tree[0u].flags = GET | IS_LEAF;
+	tree[0u].part.str = name;
+	tree[0u].part.len = strlen(name);
+	tree[0u].resp_handler = handler;
+}
+
+static const struct route_descr *resolve(struct route_cache *cache,
+					 struct route_table *table,
+					 struct route_table_reader *reader,
+					 const char *url)
+{
+	struct route_parse_result results[2u];
+	size_t count = ARRAY_SIZE(results);
+	const struct route_descr *leaf;
+
+	const struct route_table_version *const v = route_table_read_lock(table, reader);
+	leaf = route_cache_resolve(cache, v, url, strlen(url), GET, METHODS_MASK,
+				   results, &count, NULL);
+	route_table_read_unlock(reader);
+
+	return leaf;
+}
+
+/* A version published again, in the same memory and with the same root,
+ * must not hit the entries resolved in its previous tree
+ */
+static void test_cache_generation(void)
+{
+	struct route_cache_entry entries[4u];
+	struct route_cache cache;
+	struct route_table_reader readers[1u];
+	struct route_table table;
+	struct route_table_version v1 = ROUTE_TABLE_VERSION(tree, 1u, NULL);
+	struct route_table_version v2 = ROUTE_TABLE_VERSION(other, 1u, NULL);
+
+	tree_set("a");
+	TEST_ASSERT(route_cache_init(&cache, entries, ARRAY_SIZE(entries)) == 0);
+	TEST_ASSERT(route_table_init(&table, readers, ARRAY_SIZE(readers), &v1) == 0);
+
+	TEST_ASSERT(resolve(&cache, &table, &readers[0u], "/a") == &tree[0u]);
+	TEST_ASSERT(resolve(&cache, &table, &readers[0u], "/a") == &tree[0u]);
+	TEST_ASSERT(cache.hits == 1u);
+
+	TEST_ASSERT(route_table_publish(&table, &v2) == 0);
+	TEST_ASSERT(resolve(&cache, &table, &readers[0u], "/a") == NULL);
+	TEST_ASSERT(resolve(&cache, &table, &readers[0u], "/other") == &other[0u]);
+
+	/* v1 is released, rebuild its tree and publish it again */
+	tree_set("b");
+	TEST_ASSERT(route_table_publish(&table, &v1) == 0);
+	TEST_ASSERT(v1.generation != v2.generation);
+
+	TEST_ASSERT(resolve(&cache, &table, &readers[0u], "/b") == &tree[0u]);
+
+	/* Same version, root and size as the entries, other generation */
+	tree_set("c");
+	TEST_ASSERT(route_table_publish(&table, &v2) == 0);
+	TEST_ASSERT(route_table_publish(&table, &v1) == 0);
+	TEST_ASSERT(resolve(&cache, &table, &readers[0u], "/b") == NULL);
+	TEST_ASSERT(resolve(&cache, &table, &readers[0u], "/c") == &tree[0u]);
+}
+
+int main(void)
+{
+	test_cache_generation();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "routes.h"
+#include "test.h"
+
+#define RESULTS_COUNT 8u
+#define URL_SIZE 128u
+
+/* Random URLs resolved, in batches of BATCH_SIZE */
+#define URL_COUNT 20000u
+#define BATCH_SIZE 16u
+
+struct request {
+	uint32_t method;
+	char url[URL_SIZE];
+	size_t len;
+};
+
+struct resolution {
+	const struct route_descr *leaf;
+	struct route_parse_result results[RESULTS_COUNT];
+	size_t count;
+	const char *query_string;
+};
+
+static const uint32_t methods[] = {GET, POST, PUT, DELETE};
+
+/* Segments of samples/routes.txt, arguments, near misses and empty ones */
+static const char *const tokens[] = {
+	"devices", "caniot", "12", "endpoint", "blc", "blc0", "blc1", "command",
+	"attribute", "ff", "EEff", "test", "payload", "mystr", "", "xiaomi",
+	"files", "lua", "route_args", "-1", "0", "telemetry", "metrics",
+	"metrics_demo", "info", "index.html", "room", "ha", "stats", "if", "can",
+	"garage", "headers", "credentials", "flash", "fetch", "demo", "json",
+	"execute", "customSTR", "big_payload", "streaming", "messaging",
+	"metrics_controller", "controller", "dfu", "4294967296", "xyz",
+};
+
+static _Alignas(void *) unsigned char arena[65536u];
+
+static struct route_cache_entry entries[64u];
+static struct route_cache cache;
+/* Static tree, never published */
+static struct route_table_version routes_version;
+
+static const struct route_descr *built_root;
+static size_t built_size;
+
+static uint32_t prng_state = 0x2545f491u;
+
+static uint32_t prng(void)
+{
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 17;
+	prng_state ^= prng_state << 5;
+
+	return prng_state;
+}
+
+/* Tree of samples/routes.txt built at runtime, without the query schemas */
+static int build_routes(void)
+{
+	struct route_tree_builder b;
+	char line[256u];
+	int ret;
+
+	FILE *const f = fopen(ROUTES_TXT, "r");
+	if (!f)
+		return -ENOENT;
+
+	ret = route_tree_builder_init(&b, arena, sizeof(arena));
+	if (ret)
+		goto exit;
+
+	while (fgets(line, sizeof(line), f)) {
+		char method[8u], path[128u], route[160u];
+
+		if (sscanf(line, "%7s %127s", method, path) != 2 || path[0] != '/')
+			continue;
+
+		path[strcspn(path, "?")] = '\0';
+		snprintf(route, sizeof(route), "%s %s", method, path);
+
+		ret = route_tree_builder_add(&b, route, NULL, NULL, 0u);
+		if (ret)
+			goto exit;
+	}
+
+	ret = route_tree_builder_finish(&b, &built_root, &built_size);
+
+exit:
+	fclose(f);
+
+	return ret;
+}
+
+static void request_random(struct request *req)
+{
+	const size_t segments = prng() % 7u;
+	size_t len = 0u;
+
+	req->method = methods[prng() % ARRAY_SIZE(methods)];
+
+	if (prng() % 4u)
+		req->url[len++] = '/';
+
+	for (size_t i = 0u; i < segments; i++) {
+		const char *const tok = tokens[prng() % ARRAY_SIZE(tokens)];
+		const size_t n = strlen(tok);
+
+		memcpy(&req->url[len], tok, n);
+		len += n;
+
+		if (i + 1u < segments || !(prng() % 5u))
+			req->url[len++] = '/';
+	}
+
+	if (!(prng() % 8u)) {
+		memcpy(&req->url[len], "?q=1", 4u);
+		len += 4u;
+	}
+
+	req->url[len] = '\0';
+	req->len = len;
+}
+
+static bool same_arg(const struct route_parse_result *a,
+		     const struct route_parse_result *b)
+{
+	const uint32_t flags = a->descr->flags;
+
+	if (flags & ROUTE_ARG_STR)
+		return a->part.str == b->part.str && a->part.len == b->part.len;
+
+	if (flags & ROUTE_ARG_64)
+		return a->uint64 == b->uint64;
+
+	if (flags & (ROUTE_ARG_UINT | ROUTE_ARG_HEX | ROUTE_ARG_INT))
+		return a->uint == b->uint;
+
+	return true;
+}
+
+/* Same leaf, same results and same query string */
+static void check_same(const struct request *req,
+		       const char *name,
+		       const struct resolution *a,
+		       const struct resolution *b)
+{
+	bool same = (a->leaf == b->leaf);
+
+	if (same && a->leaf) {
+		same = (a->count == b->count) && (a->query_string == b->query_string);
+
+		for (size_t j = 0u; same && j < a->count; j++) {
+			same = (a->results[j].descr == b->results[j].descr) &&
+			       (a->results[j].depth == b->results[j].depth) &&
+			       same_arg(&a->results[j], &b->results[j]);
+		}
+	}
+
+	if (!same)
+		printf("%s: %s %u differs\n", name, req->url, (unsigned int)req->method);
+
+	TEST_ASSERT(same);
+}
+
+static bool same_descr(const struct route_descr *a, const struct route_descr *b)
+{
+	if (a->flags != b->flags || a->part.len != b->part.len ||
+	    memcmp(a->part.str, b->part.str, a->part.len))
+		return false;
+
+	return ((a->flags & IS_LEAF_MASK) == IS_LEAF) ||
+	       a->children.count == b->children.count;
+}
+
+/* Built tree has its own descriptors, they are compared by content */
+static void check_built(const struct request *req,
+			const struct resolution *a,
+			const struct resolution *b)
+{
+	bool same = (!a->leaf == !b->leaf);
+
+	if (same && a->leaf) {
+		same = (a->count == b->count) && (a->query_string == b->query_string);
+
+		for (size_t j = 0u; same && j < a->count; j++) {
+			same = same_descr(a->results[j].descr, b->results[j].descr) &&
+			       (a->results[j].depth == b->results[j].depth) &&
+			       same_arg(&a->results[j], &b->results[j]);
+		}
+	}
+
+	if (!same)
+		printf("builder: %s %u differs\n", req->url, (unsigned int)req->method);
+
+	TEST_ASSERT(same);
+}
+
+static void resolution_init(struct resolution *r)
+{
+	memset(r, 0, sizeof(*r));
+	r->count = RESULTS_COUNT;
+}
+
+/* All resolvers of a batch of requests against route_tree_resolve_const() */
+static void check_requests(const struct request reqs[], size_t count)
+{
+	struct route_batch batch[BATCH_SIZE];
+	struct resolution batched[BATCH_SIZE];
+
+	for (size_t i = 0u; i < count; i++) {
+		resolution_init(&batched[i]);
+
+		batch[i].url = reqs[i].url;
+		batch[i].len = reqs[i].len;
+		batch[i].flags = reqs[i].method;
+		batch[i].results = batched[i].results;
+		batch[i].results_count = RESULTS_COUNT;
+	}
+
+	const size_t resolved = route_tree_resolve_batch(routes_root, routes_root_size,
+							 METHODS_MASK, batch, count);
+	size_t expected = 0u;
+
+	for (size_t i = 0u; i < count; i++) {
+		const struct request *const req = &reqs[i];
+		struct resolution ref, r;
+
+		resolution_init(&ref);
+		ref.leaf = route_tree_resolve_const(routes_root, routes_root_size,
+						    req->url, req->len, req->method,
+						    METHODS_MASK, ref.results, &ref.count,
+						    &ref.query_string);
+		if (ref.leaf)
+			expected++;
+
+		resolution_init(&r);
+		r.leaf = routes_match(req->url, req->len, req->method, METHODS_MASK,
+				      r.results, &r.count, &r.query_string);
+		check_same(req, "matcher", &ref, &r);
+
+		resolution_init(&r);
+		r.leaf = route_tree_resolve_const(routes_root_section, ROUTE_ROOT_SECTION,
+						  req->url, req->len, req->method,
+						  METHODS_MASK, r.results, &r.count,
+						  &r.query_string);
+		check_same(req, "root section", &ref, &r);
+
+		resolution_init(&r);
+		r.leaf = route_tree_resolve_backtrack(routes_root, routes_root_size,
+						      req->url, req->len, req->method,
+						      METHODS_MASK, r.results, &r.count,
+						      &r.query_string);
+		check_same(req, "backtrack", &ref, &r);
+
+		/* Miss then hit */
+		for (size_t k = 0u; k < 2u; k++) {
+			resolution_init(&r);
+			r.leaf = route_cache_resolve(&cache, &routes_version, req->url,
+						     req->len, req->method, METHODS_MASK,
+						     r.results, &r.count, &r.query_string);
+			check_same(req, "cache", &ref, &r);
+		}
+
+		batched[i].leaf = batch[i].leaf;
+		batched[i].count = batch[i].results_count;
+		batched[i].query_string = batch[i].query_string;
+		check_same(req, "batch", &ref, &batched[i]);
+
+		resolution_init(&r);
+		r.leaf = route_tree_resolve_const(built_root, built_size, req->url,
+						  req->len, req->method, METHODS_MASK,
+						  r.results, &r.count, &r.query_string);
+		check_built(req, &ref, &r);
+	}
+
+	TEST_ASSERT(resolved == expected);
+}
+
+/* Every route of samples/routes.txt, with arguments */
+static size_t requests_routes(struct request reqs[], size_t size)
+{
+	static const char *const routes[] = {
+		"GET /", "GET /index.html", "GET /fetch", "GET /info",
+		"GET /credentials/flash", "GET /metrics", "GET /metrics_controller",
+		"GET /metrics_demo", "GET /devices/", "POST /devices/",
+		"GET /room/12", "GET /devices/xiaomi?limit=1&cursor=1f&q=abc",
+		"GET /devices/caniot", "GET /ha/stats", "POST /files", "GET /files",
+		"GET /files/lua", "DELETE /files/lua", "POST /lua/execute",
+		"GET /demo/json", "POST /dfu", "GET /dfu", "GET /devices/garage",
+		"POST /devices/garage", "POST /devices/caniot/1/endpoint/blc0/command",
+		"POST /devices/caniot/2/endpoint/blc1/command",
+		"POST /devices/caniot/3/endpoint/blc/command",
+		"GET /devices/caniot/4/endpoint/5/telemetry",
+		"POST /devices/caniot/4/endpoint/5/command",
+		"GET /devices/caniot/6/attribute/ff",
+		"PUT /devices/caniot/6/attribute/1a2b", "POST /if/can/7f",
+		"POST /test/messaging", "POST /test/streaming",
+		"POST /test/route_args/1/2/3", "POST /test/big_payload",
+		"GET /test/headers", "GET /test/payload", "GET /test/abc/mystr",
+	};
+	size_t count = 0u;
+
+	for (size_t i = 0u; i < ARRAY_SIZE(routes) && count < size; i++) {
+		struct request *const req = &reqs[count++];
+		const char *const path = strchr(routes[i], ' ') + 1u;
+
+		req->method = (routes[i][0] == 'G') ? GET :
+			      (routes[i][1] == 'O') ? POST :
+			      (routes[i][1] == 'U') ? PUT : DELETE;
+		req->len = strlen(path);
+		memcpy(req->url, path, req->len + 1u);
+	}
+
+	return count;
+}
+
+static void test_differential(void)
+{
+	struct request reqs[BATCH_SIZE];
+	size_t count;
+
+	TEST_ASSERT(build_routes() == 0);
+	TEST_ASSERT(route_cache_init(&cache, entries, ARRAY_SIZE(entries)) == 0);
+
+	routes_version.root = routes_root;
+	routes_version.size = routes_root_size;
+
+	/* Routes all resolve, CONFIG_DFU ones included */
+	struct request all[64u];
+	const size_t n = requests_routes(all, ARRAY_SIZE(all));
+
+	for (size_t i = 0u; i < n; i++) {
+		struct route_parse_result results[RESULTS_COUNT];
+		size_t c = RESULTS_COUNT;
+
+		TEST_ASSERT(route_tree_resolve_const(routes_root, routes_root_size,
+						     all[i].url, all[i].len, all[i].method,
+						     METHODS_MASK, results, &c, NULL) != NULL);
+	}
+
+	for (size_t i = 0u; i < n; i += BATCH_SIZE)
+		check_requests(&all[i], MIN(n - i, BATCH_SIZE));
+
+	for (size_t i = 0u; i < URL_COUNT; i += BATCH_SIZE) {
+		count = MIN(URL_COUNT - i, BATCH_SIZE);
+
+		for (size_t k = 0u; k < count; k++)
+			request_random(&reqs[k]);
+
+		check_requests(reqs, count);
+	}
+}
+
+int main(void)
+{
+	test_differential();
+
+	return TEST_RESULT();
+}
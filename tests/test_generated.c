@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "routes.h"
+#include "routes_gen.h"
+#include "test.h"
+
+#define RESULTS_COUNT 8u
+
+struct request {
+	uint32_t method;
+	const char *url;
+};
+
+/* Routes of samples/routes.txt, typed segments and unknown ones */
+static const struct request requests[] = {
+	{GET, "/"},
+	{GET, "/index.html"},
+	{GET, "/fetch"},
+	{GET, "/info"},
+	{GET, "/credentials/flash"},
+	{GET, "/metrics"},
+	{GET, "/metrics_controller"},
+	{GET, "/metrics_demo"},
+	{GET, "/devices/"},
+	{POST, "/devices"},
+	{GET, "/room/12"},
+	{GET, "/room/x"},
+	{GET, "/devices/xiaomi?limit=1&cursor=1f&q=abc"},
+	{GET, "/devices/caniot"},
+	{GET, "/ha/stats"},
+	{POST, "/files"},
+	{GET, "/files"},
+	{GET, "/files/lua"},
+	{DELETE, "/files/lua"},
+	{POST, "/lua/execute"},
+	{GET, "/demo/json"},
+	{GET, "/dfu"},
+	{GET, "/devices/garage"},
+	{POST, "/devices/garage"},
+	{POST, "/devices/caniot/1/endpoint/blc0/command"},
+	{POST, "/devices/caniot/2/endpoint/blc1/command"},
+	{POST, "/devices/caniot/3/endpoint/blc/command"},
+	{GET, "/devices/caniot/4/endpoint/5/telemetry"},
+	{POST, "/devices/caniot/4/endpoint/5/command"},
+	{GET, "/devices/caniot/6/attribute/ff"},
+	{PUT, "/devices/caniot/6/attribute/1a2b"},
+	{POST, "/if/can/7f"},
+	{POST, "/test/messaging"},
+	{POST, "/test/streaming"},
+	{POST, "/test/route_args/1/2/3"},
+	{POST, "/test/big_payload"},
+	{GET, "/test/headers"},
+	{GET, "/test/payload"},
+	{GET, "/test/abc/mystr"},
+	{GET, "/test/abc/other"},
+	{PUT, "/metrics"},
+	{GET, "/unknown"},
+	{GET, "/devices/caniot/x/endpoint/5/command"},
+};
+
+static void check_same(const struct route_descr *l1,
+		       const struct route_parse_result *r1,
+		       size_t c1,
+		       void (*rp)(void),
+		       void (*rq)(void),
+		       const struct route_parse_result *r2,
+		       size_t c2)
+{
+	TEST_ASSERT(!l1 == !rp);
+	if (!l1 || !rp)
+		return;
+
+	TEST_ASSERT(l1->resp_handler == rp);
+	TEST_ASSERT(l1->req_handler == rq);
+	TEST_ASSERT(c1 == c2);
+	for (size_t j = 0u; j < c1 && j < c2; j++) {
+		TEST_ASSERT(r1[j].depth == r2[j].depth);
+		TEST_ASSERT(r1[j].uint == r2[j].uint);
+	}
+}
+
+/* --lookup=jump and --packed outputs resolve the same as samples/routes_g.c */
+static void test_generated(void)
+{
+	for (size_t i = 0u; i < ARRAY_SIZE(requests); i++) {
+		const struct request *const req = &requests[i];
+		const size_t len = strlen(req->url);
+		struct route_parse_result r1[RESULTS_COUNT], r2[RESULTS_COUNT];
+		size_t c1 = RESULTS_COUNT, c2;
+		const struct route_descr *l1, *l2;
+
+		l1 = route_tree_resolve_const(routes_root, routes_root_size, req->url, len,
+					      req->method, METHODS_MASK, r1, &c1, NULL);
+
+		c2 = RESULTS_COUNT;
+		l2 = route_tree_resolve_const(routes_jump_root, routes_jump_root_size,
+					      req->url, len, req->method, METHODS_MASK,
+					      r2, &c2, NULL);
+		check_same(l1, r1, c1, l2 ? l2->resp_handler : NULL,
+			   l2 ? l2->req_handler : NULL, r2, c2);
+
+		c2 = RESULTS_COUNT;
+		l2 = route_section_resolve_const(routes_jump_root_section, req->url, len,
+						 req->method, METHODS_MASK, r2, &c2, NULL);
+		check_same(l1, r1, c1, l2 ? l2->resp_handler : NULL,
+			   l2 ? l2->req_handler : NULL, r2, c2);
+
+		c2 = RESULTS_COUNT;
+		const int node = route_packed_resolve(&routes_packed, req->url, len,
+						      req->method, METHODS_MASK,
+						      r2, &c2, NULL);
+		const struct route_packed_leaf *const pl =
+			(node >= 0) ? route_packed_leaf(&routes_packed, (uint16_t)node) : NULL;
+		check_same(l1, r1, c1, pl ? pl->resp_handler : NULL,
+			   pl ? pl->req_handler : NULL, r2, c2);
+	}
+}
+
+int main(void)
+{
+	test_generated();
+
+	return TEST_RESULT();
+}
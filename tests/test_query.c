@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "test.h"
+
+#define ARGS_MAX 8u
+#define TOKEN_SIZE 32u
+
+struct arg {
+	char key[TOKEN_SIZE];
+	char value[TOKEN_SIZE];
+	bool has_value;
+};
+
+struct args {
+	struct arg list[ARGS_MAX];
+	size_t count;
+};
+
+/* Query strings, without percent-escapes */
+static const char *const queries[] = {
+	"a=b=c",
+	"a==b",
+	"a=b=c&d=e",
+	"=x&b",
+	"=x=y&b=1",
+	"a&b=1=2&c",
+	"a=&b==",
+	"k=v=w=x&k=y",
+	"&&a=1&&",
+	"a",
+	"",
+};
+
+static void arg_set(struct arg *a,
+		    const char *key,
+		    size_t klen,
+		    const char *value,
+		    size_t vlen)
+{
+	memset(a, 0, sizeof(*a));
+	memcpy(a->key, key, MIN(klen, TOKEN_SIZE - 1u));
+
+	if (value) {
+		memcpy(a->value, value, MIN(vlen, TOKEN_SIZE - 1u));
+		a->has_value = true;
+	}
+}
+
+static void args_add(struct args *args,
+		     const char *key,
+		     size_t klen,
+		     const char *value,
+		     size_t vlen)
+{
+	if (args->count < ARGS_MAX)
+		arg_set(&args->list[args->count++], key, klen, value, vlen);
+}
+
+static bool args_same(const struct args *a, const struct args *b)
+{
+	if (a->count != b->count)
+		return false;
+
+	for (size_t i = 0u; i < a->count; i++) {
+		if (strcmp(a->list[i].key, b->list[i].key) ||
+		    a->list[i].has_value != b->list[i].has_value ||
+		    strcmp(a->list[i].value, b->list[i].value))
+			return false;
+	}
+
+	return true;
+}
+
+static void check(const char *name, const char *query,
+		  const struct args *ref, const struct args *args)
+{
+	const bool same = args_same(ref, args);
+
+	if (!same)
+		printf("%s: \"%s\" differs\n", name, query);
+
+	TEST_ASSERT(same);
+}
+
+static void parse_buffered(const char *query, struct args *args)
+{
+	struct query_arg qargs[ARGS_MAX];
+	char buf[64u];
+
+	strcpy(buf, query);
+	args->count = 0u;
+
+	const int count = query_args_parse(buf, qargs, ARGS_MAX);
+
+	for (int i = 0; i < count && i < (int)ARGS_MAX; i++) {
+		const char *const v = qargs[i].value;
+
+		args_add(args, qargs[i].key, strlen(qargs[i].key), v, v ? strlen(v) : 0u);
+	}
+}
+
+static void parse_spans(const char *query, struct args *args)
+{
+	struct query_arg_span spans[ARGS_MAX];
+
+	args->count = 0u;
+
+	const int count = query_args_parse_spans(query, strlen(query), spans, ARGS_MAX);
+
+	for (int i = 0; i < count && i < (int)ARGS_MAX; i++) {
+		const struct query_arg_span *const s = &spans[i];
+
+		args_add(args, &query[s->key.offset], s->key.len,
+			 s->value.offset ? &query[s->value.offset] : NULL, s->value.len);
+	}
+}
+
+static int url_cb(enum url_stream_event event,
+		  const struct url_stream_token *t,
+		  void *user_data)
+{
+	if (event == URL_STREAM_QUERY_ARG)
+		args_add(user_data, t->key, t->key_len, t->value, t->value_len);
+
+	return 0;
+}
+
+/* Fed by chunks of chunk bytes */
+static void parse_url_stream(const char *query, size_t chunk, struct args *args)
+{
+	struct url_stream s;
+	char url[64u];
+	char buf[64u];
+
+	snprintf(url, sizeof(url), "/p?%s", query);
+	args->count = 0u;
+	url_stream_init(&s, buf, sizeof(buf), url_cb, args);
+
+	const size_t len = strlen(url);
+	for (size_t i = 0u; i < len; i += chunk)
+		TEST_ASSERT(url_stream_feed(&s, &url[i], MIN(chunk, len - i)) >= 0);
+
+	TEST_ASSERT(url_stream_end(&s) == 0);
+}
+
+struct form_args {
+	struct args *args;
+	struct arg arg;
+	bool open;
+};
+
+/* Values are reported by pieces, concatenated until complete */
+static int form_cb(const struct url_stream_token *t, bool complete, void *user_data)
+{
+	struct form_args *const f = user_data;
+
+	if (!f->open) {
+		arg_set(&f->arg, t->key, t->key_len, t->value, 0u);
+		f->open = true;
+	}
+
+	if (t->value) {
+		strncat(f->arg.value, t->value,
+			MIN(t->value_len, TOKEN_SIZE - 1u - strlen(f->arg.value)));
+	}
+
+	if (complete) {
+		if (f->args->count < ARGS_MAX)
+			f->args->list[f->args->count++] = f->arg;
+		f->open = false;
+	}
+
+	return 0;
+}
+
+static void parse_form_stream(const char *query, size_t chunk, struct args *args)
+{
+	struct form_stream s;
+	struct form_args f = {.args = args};
+	char buf[32u];
+
+	args->count = 0u;
+	form_stream_init(&s, buf, sizeof(buf), form_cb, &f);
+
+	const size_t len = strlen(query);
+	for (size_t i = 0u; i < len; i += chunk)
+		TEST_ASSERT(form_stream_feed(&s, &query[i], MIN(chunk, len - i)) >= 0);
+
+	TEST_ASSERT(form_stream_end(&s) == 0);
+}
+
+/* Value of the first argument with each key, looked up by key */
+static void check_find(const char *query, const struct args *ref)
+{
+	for (size_t i = 0u; i < ref->count; i++) {
+		const struct arg *const a = &ref->list[i];
+		struct query_arg_span span;
+		size_t cursor = 0u;
+		char buf[64u];
+
+		/* Arguments before with the same key are found first */
+		size_t first = 0u;
+		while (strcmp(ref->list[first].key, a->key))
+			first++;
+		if (first != i)
+			continue;
+
+		strcpy(buf, query);
+		const char *const value = query_args_parse_find(buf, a->key);
+		TEST_ASSERT(!value == !a->has_value);
+		TEST_ASSERT(!value || strcmp(value, a->value) == 0);
+
+		TEST_ASSERT(query_args_parse_next(query, strlen(query), a->key, &cursor,
+						  &span) == 0);
+		TEST_ASSERT((span.value.offset != 0u) == a->has_value);
+		TEST_ASSERT(span.value.len == strlen(a->value) &&
+			    !memcmp(&query[span.value.offset], a->value, span.value.len));
+	}
+}
+
+/* Streamed and buffered parsers split arguments the same way: the key
+ * ends at the first '=', later ones belong to the value
+ */
+static void test_query_split(void)
+{
+	for (size_t i = 0u; i < ARRAY_SIZE(queries); i++) {
+		const char *const query = queries[i];
+		struct args ref, args;
+
+		parse_buffered(query, &ref);
+
+		parse_spans(query, &args);
+		check("spans", query, &ref, &args);
+
+		for (size_t chunk = 1u; chunk <= 4u; chunk++) {
+			parse_url_stream(query, chunk, &args);
+			check("url_stream", query, &ref, &args);
+
+			parse_form_stream(query, chunk, &args);
+			check("form_stream", query, &ref, &args);
+		}
+
+		check_find(query, &ref);
+	}
+
+	struct args args;
+
+	parse_buffered("a=b=c&d", &args);
+	TEST_ASSERT(args.count == 2u);
+	TEST_ASSERT(!strcmp(args.list[0u].key, "a") && !strcmp(args.list[0u].value, "b=c"));
+	TEST_ASSERT(!strcmp(args.list[1u].key, "d") && !args.list[1u].has_value);
+
+	/* Arguments are only parsed after the last '?' */
+	parse_buffered("x=1?a=2=3", &args);
+	TEST_ASSERT(args.count == 1u);
+	TEST_ASSERT(!strcmp(args.list[0u].key, "a") && !strcmp(args.list[0u].value, "2=3"));
+
+	parse_spans("x=1?a", &args);
+	TEST_ASSERT(args.count == 1u && !args.list[0u].has_value);
+}
+
+int main(void)
+{
+	test_query_split();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "test.h"
+
+static void handler(void)
+{
+}
+
+static const struct route_descr info[] = {
+	LEAF("", GET, handler, NULL, 0u),
+	LEAF("version", GET, handler, NULL, 0u),
+};
+
+static const struct route_descr root[] = {
+	SECTION("info", 0u, info, ARRAY_SIZE(info), 0u),
+};
+
+/* A results array one element too small must not be written past its end */
+static void test_results_too_small(void)
+{
+	struct route_parse_result results[3u];
+	const struct route_descr *leaf;
+	size_t count;
+	char url[32u];
+
+	/* "/info" needs 2 results: the section and its unnamed leaf */
+	memset(results, 0, sizeof(results));
+	strcpy(url, "/info");
+	count = 1u;
+	leaf = route_tree_resolve(root, ARRAY_SIZE(root), url, GET, METHODS_MASK,
+				  results, &count, NULL);
+	TEST_ASSERT(leaf == NULL);
+	TEST_ASSERT(count == 0u);
+	TEST_ASSERT(results[1u].descr == NULL);
+
+	count = 1u;
+	leaf = route_tree_resolve_const(root, ARRAY_SIZE(root), "/info/version",
+					strlen("/info/version"), GET, METHODS_MASK,
+					results, &count, NULL);
+	TEST_ASSERT(leaf == NULL);
+	TEST_ASSERT(results[1u].descr == NULL);
+
+	/* Exact fit */
+	strcpy(url, "/info");
+	count = 2u;
+	leaf = route_tree_resolve(root, ARRAY_SIZE(root), url, GET, METHODS_MASK,
+				  results, &count, NULL);
+	TEST_ASSERT(leaf == &info[0u]);
+	TEST_ASSERT(count == 2u);
+	TEST_ASSERT(results[2u].descr == NULL);
+
+	count = 2u;
+	leaf = route_tree_resolve_const(root, ARRAY_SIZE(root), "/info/version",
+					strlen("/info/version"), GET, METHODS_MASK,
+					results, &count, NULL);
+	TEST_ASSERT(leaf == &info[1u]);
+	TEST_ASSERT(count == 2u);
+	TEST_ASSERT(results[2u].descr == NULL);
+}
+
+static const struct route_descr dev_ts[] = {
+	LEAF("name:s", GET | ARG_STR, handler, NULL, 0u),
+};
+
+static const struct route_descr dev_id[] = {
+	SECTION("ts:u64", ARG_UINT | ARG_64, dev_ts, ARRAY_SIZE(dev_ts), 0u),
+};
+
+static const struct route_descr dev[] = {
+	SECTION("id:u", ARG_UINT, dev_id, ARRAY_SIZE(dev_id), 0u),
+};
+
+static const struct route_descr dev_root[] = {
+	SECTION("dev", 0u, dev, ARRAY_SIZE(dev), 0u),
+};
+
+/* Names are compared up to the ':' of the type, whatever its length */
+static void test_results_get(void)
+{
+	static const char url[] = "/dev/12/123456789012/abc";
+	struct route_parse_result results[4u];
+	size_t count = ARRAY_SIZE(results);
+	void *arg;
+
+	TEST_ASSERT(route_tree_resolve_const(dev_root, ARRAY_SIZE(dev_root), url,
+					     strlen(url), GET, METHODS_MASK, results,
+					     &count, NULL) == &dev_ts[0u]);
+	TEST_ASSERT(count == 4u);
+
+	arg = NULL;
+	TEST_ASSERT(route_results_get(results, count, "id", ARG_UINT, &arg) == 0);
+	TEST_ASSERT(arg == results[1u].arg && results[1u].uint == 12u);
+
+	arg = NULL;
+	TEST_ASSERT(route_results_get(results, count, "ts", ARG_UINT, &arg) == 0);
+	TEST_ASSERT(arg == results[2u].arg && results[2u].uint64 == 123456789012ull);
+
+	arg = NULL;
+	TEST_ASSERT(route_results_get(results, count, "name", ARG_STR, &arg) == 0);
+	TEST_ASSERT(arg != NULL && strncmp((const char *)arg, "abc", 3u) == 0);
+
+	TEST_ASSERT(route_results_get(results, count, "i", ARG_UINT, &arg) == -ENOENT);
+	TEST_ASSERT(route_results_get(results, count, "ts:u", ARG_UINT, &arg) == -ENOENT);
+	TEST_ASSERT(route_results_get(results, count, "dev", ARG_UINT, &arg) == -ENOENT);
+	TEST_ASSERT(route_results_get(results, count, "name", ARG_UINT, &arg) == -ENOENT);
+}
+
+static const struct route_descr num_leaf[] = {
+	LEAF("h:x", GET | ARG_HEX, handler, NULL, 0u),
+};
+
+static const struct route_descr num_i64[] = {
+	SECTION("big:i64", ARG_INT | ARG_64, num_leaf, ARRAY_SIZE(num_leaf), 0u),
+};
+
+static const struct route_descr num_u64[] = {
+	SECTION("wide:u64", ARG_UINT | ARG_64, num_i64, ARRAY_SIZE(num_i64), 0u),
+};
+
+static const struct route_descr num_root[] = {
+	SECTION("i:i", ARG_INT, num_u64, ARRAY_SIZE(num_u64), 0u),
+};
+
+/* Numeric helpers read the type of each argument, 64-bit values are not
+ * truncated
+ */
+static void test_results_numbers(void)
+{
+	static const char url[] = "/-5/123456789012/-123456789012/000000001f";
+	struct route_parse_result results[4u];
+	size_t count = ARRAY_SIZE(results);
+	uint32_t n;
+	int32_t sint;
+	uint64_t u64;
+	int64_t s64;
+
+	TEST_ASSERT(route_tree_resolve_const(num_root, ARRAY_SIZE(num_root), url,
+					     strlen(url), GET, METHODS_MASK, results,
+					     &count, NULL) == &num_leaf[0u]);
+	TEST_ASSERT(count == 4u);
+
+	/* :i */
+	TEST_ASSERT(route_results_find_sint(results, count, &num_root[0u], &sint) == 0);
+	TEST_ASSERT(sint == -5);
+	TEST_ASSERT(route_results_get_number_by_index(results, count, 0u, &n) == 0);
+	TEST_ASSERT(n == (uint32_t)-5);
+	TEST_ASSERT(route_results_get_s64_by_index(results, count, 0u, &s64) == 0);
+	TEST_ASSERT(s64 == -5);
+	TEST_ASSERT(route_results_get_uint_by_index(results, count, 0u, &n) == -EINVAL);
+
+	/* :u64 */
+	TEST_ASSERT(route_results_find_u64(results, count, &num_u64[0u], &u64) == 0);
+	TEST_ASSERT(u64 == 123456789012ull);
+	TEST_ASSERT(route_results_get_u64_by_index(results, count, 1u, &u64) == 0);
+	TEST_ASSERT(u64 == 123456789012ull);
+	TEST_ASSERT(route_results_find_number(results, count, &num_u64[0u], &n) == -EINVAL);
+	TEST_ASSERT(route_results_get_uint_by_index(results, count, 1u, &n) == -EINVAL);
+
+	/* :i64 */
+	TEST_ASSERT(route_results_find_s64(results, count, &num_i64[0u], &s64) == 0);
+	TEST_ASSERT(s64 == -123456789012ll);
+	TEST_ASSERT(route_results_get_sint_by_index(results, count, 2u, &sint) == -EINVAL);
+
+	/* :x, leading zeros don't count in its 8 digits */
+	TEST_ASSERT(route_results_find_number(results, count, &num_leaf[0u], &n) == 0);
+	TEST_ASSERT(n == 0x1fu);
+	TEST_ASSERT(route_results_get_u64_by_index(results, count, 3u, &u64) == 0);
+	TEST_ASSERT(u64 == 0x1fu);
+	TEST_ASSERT(route_results_get_s64_by_index(results, count, 3u, &s64) == -EINVAL);
+
+	TEST_ASSERT(route_results_get_u64_by_index(results, count, 4u, &u64) == -ENOENT);
+
+	count = ARRAY_SIZE(results);
+	TEST_ASSERT(route_tree_resolve_const(num_root, ARRAY_SIZE(num_root),
+					     "/1/2/3/1000000001f", 18u, GET, METHODS_MASK,
+					     results, &count, NULL) == NULL);
+}
+
+/* "/dev/:id/:name" as packed tables, sections with user data */
+static const char packed_pool[] = "dev\0id:u\0name:s";
+static const uint16_t packed_name[] = {0u, 4u, 9u};
+static const uint8_t packed_len[] = {3u, 4u, 6u};
+static const uint16_t packed_flags[] = {0u, ARG_UINT, GET | ARG_STR | IS_LEAF};
+static const uint16_t packed_index[] = {1u, 2u, 0u};
+static const uint16_t packed_count[] = {1u, 1u, 0u};
+static const uint32_t packed_user_data[] = {3u, 4u, 0u};
+
+static const struct route_packed_leaf packed_leaves[] = {
+	ROUTE_PACKED_LEAF(handler, NULL, NULL, 5u),
+};
+
+static const struct route_packed packed =
+	ROUTE_PACKED(packed_pool, packed_name, packed_len, packed_flags,
+		     packed_index, packed_count, packed_leaves, packed_user_data,
+		     1u, 3u);
+
+/* Packed results have no descriptor, arguments are found by node */
+static void test_results_packed(void)
+{
+	static const char url[] = "/dev/12/abc";
+	struct route_parse_result results[3u];
+	struct route_descr descrs[3u];
+	size_t count = ARRAY_SIZE(results);
+	void *arg;
+
+	TEST_ASSERT(route_packed_resolve(&packed, url, strlen(url), GET, METHODS_MASK,
+					 results, &count, NULL) == 2);
+	TEST_ASSERT(count == 3u);
+
+	TEST_ASSERT(route_results_get(results, count, "id", ARG_UINT, &arg) == -ENOENT);
+
+	arg = NULL;
+	TEST_ASSERT(route_packed_results_get(&packed, results, count, "id", ARG_UINT,
+					     &arg) == 0);
+	TEST_ASSERT(arg == results[1u].arg && results[1u].uint == 12u);
+
+	arg = NULL;
+	TEST_ASSERT(route_packed_results_get(&packed, results, count, "name", ARG_STR,
+					     &arg) == 0);
+	TEST_ASSERT(arg != NULL && strncmp((const char *)arg, "abc", 3u) == 0);
+
+	TEST_ASSERT(route_packed_results_get(&packed, results, count, "dev", ARG_UINT,
+					     &arg) == -ENOENT);
+
+	route_packed_expand(&packed, results, count, descrs);
+	TEST_ASSERT(descrs[0u].user_data == 3u && descrs[1u].user_data == 4u);
+	TEST_ASSERT(descrs[2u].user_data == 5u);
+	TEST_ASSERT(route_results_get(results, count, "id", ARG_UINT, &arg) == 0);
+}
+
+int main(void)
+{
+	test_results_too_small();
+	test_results_get();
+	test_results_numbers();
+	test_results_packed();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+#include <embedc-url/table.h>
+
+#include "test.h"
+
+static void handler(void)
+{
+}
+
+static const struct route_descr info[] = {
+	LEAF("", GET, handler, NULL, 0u),
+	LEAF("version", GET, handler, NULL, 0u),
+};
+
+/* Statics sorted by name, then typed children, as genroutes.py does */
+static const struct route_descr root[] = {
+	SECTION("info", 0u, info, ARRAY_SIZE(info), 0u),
+	LEAF("metrics", GET, handler, NULL, 0u),
+	LEAF(":u", GET | ARG_UINT, handler, NULL, 0u),
+};
+
+/* 'i' is [0, 1), 'm' is [1, 2) */
+static const uint8_t root_jump[] = {0u, 1u, 1u, 1u, 1u, 2u};
+
+static const struct route_lookup root_lookup =
+	ROUTE_JUMP(root_jump, 'i', 'm' - 'i' + 1u, 2u);
+
+static const struct route_descr root_section =
+	SECTION_LOOKUP("", 0u, root, ARRAY_SIZE(root), &root_lookup, 0u);
+
+/* Resolving from the root section must give the same results as from the
+ * root array
+ */
+static void test_section_resolve(void)
+{
+	static const char *const urls[] = {
+		"/info", "/info/version?x=1", "/metrics", "/42", "/metricz", "/",
+		"/info/x",
+	};
+
+	for (size_t i = 0u; i < ARRAY_SIZE(urls); i++) {
+		struct route_parse_result r1[4u], r2[4u];
+		size_t c1 = ARRAY_SIZE(r1), c2 = ARRAY_SIZE(r2);
+		const char *q1 = NULL, *q2 = NULL;
+		const size_t len = strlen(urls[i]);
+
+		const struct route_descr *const l1 =
+			route_tree_resolve_const(root, ARRAY_SIZE(root), urls[i], len, GET,
+						 METHODS_MASK, r1, &c1, &q1);
+		const struct route_descr *const l2 =
+			route_section_resolve_const(&root_section, urls[i], len, GET,
+						    METHODS_MASK, r2, &c2, &q2);
+
+		TEST_ASSERT(l1 == l2);
+		TEST_ASSERT(c1 == c2);
+		TEST_ASSERT(q1 == q2);
+		for (size_t j = 0u; l1 && j < c1; j++) {
+			TEST_ASSERT(r1[j].descr == r2[j].descr);
+		}
+	}
+
+	size_t count = 4u;
+	struct route_parse_result results[4u];
+
+	TEST_ASSERT(route_section_resolve_const(&root[1u], "/", 1u, GET, METHODS_MASK,
+						results, &count, NULL) == NULL);
+}
+
+/* Same children, but the lookup hides "metrics" ('m' is [2, 2), no static
+ * child): found only if the lookup is not used
+ */
+static const uint8_t hidden_jump[] = {0u, 1u, 2u, 2u, 2u, 2u};
+
+static const struct route_lookup hidden_lookup =
+	ROUTE_JUMP(hidden_jump, 'i', 'm' - 'i' + 1u, 2u);
+
+static const struct route_descr hidden_section =
+	SECTION_LOOKUP("", 0u, root, ARRAY_SIZE(root), &hidden_lookup, 0u);
+
+static const struct route_descr *resolve_stream(const char *url, size_t *count)
+{
+	struct route_parse_result results[4u];
+	struct route_stream rs;
+	char buf[32u];
+
+	route_stream_init(&rs, &hidden_section, ROUTE_ROOT_SECTION, GET, METHODS_MASK,
+			  results, ARRAY_SIZE(results), buf, sizeof(buf));
+	route_stream_feed(&rs, url, strlen(url));
+	route_stream_end(&rs);
+
+	return route_stream_leaf(&rs, count);
+}
+
+/* Resolvers given a root section use its lookup */
+static void test_section_root(void)
+{
+	struct route_parse_result results[4u];
+	struct route_cache_entry entries[4u];
+	struct route_cache cache;
+	struct route_table_version version =
+		ROUTE_TABLE_VERSION(&hidden_section, ROUTE_ROOT_SECTION, NULL);
+	struct route_batch batch[2u] = {
+		{.url = "/metrics", .len = 8u, .flags = GET},
+		{.url = "/info/version", .len = 13u, .flags = GET},
+	};
+	struct route_parse_result batch_results[2u][4u];
+	char url[32u];
+	size_t count;
+
+	TEST_ASSERT(route_cache_init(&cache, entries, ARRAY_SIZE(entries)) == 0);
+
+	for (size_t i = 0u; i < 2u; i++) {
+		const char *const path = batch[i].url;
+		const size_t len = strlen(path);
+		const struct route_descr *const expected = i ? &info[1u] : NULL;
+
+		strcpy(url, path);
+		count = ARRAY_SIZE(results);
+		TEST_ASSERT(route_tree_resolve(&hidden_section, ROUTE_ROOT_SECTION, url, GET,
+					       METHODS_MASK, results, &count, NULL) == expected);
+
+		count = ARRAY_SIZE(results);
+		TEST_ASSERT(route_tree_resolve_const(&hidden_section, ROUTE_ROOT_SECTION,
+						     path, len, GET, METHODS_MASK, results,
+						     &count, NULL) == expected);
+
+		count = ARRAY_SIZE(results);
+		TEST_ASSERT(route_tree_resolve_backtrack(&hidden_section, ROUTE_ROOT_SECTION,
+							 path, len, GET, METHODS_MASK,
+							 results, &count, NULL) == expected);
+
+		count = ARRAY_SIZE(results);
+		TEST_ASSERT(route_cache_resolve(&cache, &version, path, len, GET,
+						METHODS_MASK, results, &count,
+						NULL) == expected);
+
+		TEST_ASSERT(resolve_stream(path, &count) == expected);
+
+		batch[i].results = batch_results[i];
+		batch[i].results_count = ARRAY_SIZE(batch_results[i]);
+	}
+
+	TEST_ASSERT(route_tree_resolve_batch(&hidden_section, ROUTE_ROOT_SECTION,
+					     METHODS_MASK, batch, ARRAY_SIZE(batch)) == 1u);
+	TEST_ASSERT(batch[0u].leaf == NULL && batch[1u].leaf == &info[1u]);
+
+	/* A leaf is not a root section */
+	count = ARRAY_SIZE(results);
+	TEST_ASSERT(route_tree_resolve_const(&root[1u], ROUTE_ROOT_SECTION, "/", 1u, GET,
+					     METHODS_MASK, results, &count, NULL) == NULL);
+	TEST_ASSERT(count == 0u);
+}
+
+int main(void)
+{
+	test_section_resolve();
+	test_section_root();
+
+	return TEST_RESULT();
+}
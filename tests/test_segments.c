@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+
+#include "test.h"
+
+/* Deeper than CONFIG_EMBEDC_URL_PARSER_MAX_SEGMENTS */
+#define DEPTH 24u
+
+static void handler(void)
+{
+}
+
+/* "/s/s/.../s/:u", DEPTH - 1 sections then a leaf */
+static struct route_descr deep[DEPTH];
+
+static void deep_init(void)
+{
+	for (size_t i = 0u; i + 1u < DEPTH; i++) {
+		deep[i].flags = 0u;
+		deep[i].part.str = "s";
+		deep[i].part.len = 1u;
+		deep[i].children.list = &deep[i + 1u];
+		deep[i].children.count = 1u;
+	}
+
+	deep[DEPTH - 1u].flags = GET | ARG_UINT | IS_LEAF;
+	deep[DEPTH - 1u].part.str = ":u";
+	deep[DEPTH - 1u].part.len = 2u;
+	deep[DEPTH - 1u].resp_handler = handler;
+}
+
+static const char *deep_url(void)
+{
+	static char url[2u * DEPTH + 16u];
+	char *p = url;
+
+	for (size_t i = 0u; i + 1u < DEPTH; i++) {
+		*p++ = '/';
+		*p++ = 's';
+	}
+	strcpy(p, "/42?x=1");
+
+	return url;
+}
+
+static void check_results(const struct route_descr *leaf,
+			  const struct route_parse_result *results,
+			  size_t count)
+{
+	TEST_ASSERT(leaf == &deep[DEPTH - 1u]);
+	TEST_ASSERT(count == DEPTH);
+	if (leaf && count == DEPTH) {
+		TEST_ASSERT(results[DEPTH - 1u].depth == DEPTH);
+		TEST_ASSERT(results[DEPTH - 1u].uint == 42u);
+	}
+}
+
+static void test_deep_resolve(void)
+{
+	const char *const url = deep_url();
+	struct route_parse_result results[DEPTH + 1u];
+	const struct route_descr *leaf;
+	const char *query;
+	char *mquery;
+	size_t count;
+	char buf[2u * DEPTH + 16u];
+
+	strcpy(buf, url);
+	count = ARRAY_SIZE(results);
+	leaf = route_tree_resolve(deep, 1u, buf, GET, METHODS_MASK,
+				  results, &count, &mquery);
+	check_results(leaf, results, count);
+	TEST_ASSERT(leaf && strcmp(mquery, "x=1") == 0);
+
+	count = ARRAY_SIZE(results);
+	leaf = route_tree_resolve_const(deep, 1u, url, strlen(url), GET,
+					METHODS_MASK, results, &count, &query);
+	check_results(leaf, results, count);
+	TEST_ASSERT(leaf && strcmp(query, "x=1") == 0);
+
+	count = ARRAY_SIZE(results);
+	leaf = route_tree_resolve_backtrack(deep, 1u, url, strlen(url), GET,
+					    METHODS_MASK, results, &count, &query);
+	check_results(leaf, results, count);
+
+	struct route_cache_entry entries[4u];
+	struct route_cache cache;
+	const struct route_table_version version = ROUTE_TABLE_VERSION(deep, 1u, NULL);
+
+	TEST_ASSERT(route_cache_init(&cache, entries, ARRAY_SIZE(entries)) == 0);
+	for (int i = 0; i < 2; i++) {
+		count = ARRAY_SIZE(results);
+		leaf = route_cache_resolve(&cache, &version, url, strlen(url), GET,
+					   METHODS_MASK, results, &count, &query);
+		check_results(leaf, results, count);
+	}
+
+	struct route_batch batch = {
+		.url = url,
+		.len = strlen(url),
+		.flags = GET,
+		.results = results,
+		.results_count = ARRAY_SIZE(results),
+	};
+
+	TEST_ASSERT(route_tree_resolve_batch(deep, 1u, METHODS_MASK, &batch, 1u) == 1u);
+	check_results(batch.leaf, results, batch.results_count);
+
+	/* Unknown segment past the table size */
+	strcpy(buf, url);
+	buf[2u * (DEPTH - 2u) + 1u] = 'x';
+	count = ARRAY_SIZE(results);
+	TEST_ASSERT(!route_tree_resolve_const(deep, 1u, buf, strlen(buf), GET,
+					      METHODS_MASK, results, &count, &query));
+	TEST_ASSERT(count == 0u);
+}
+
+static void test_segment_table_full(void)
+{
+	struct route_part parts[DEPTH / 2u];
+	size_t count = ARRAY_SIZE(parts);
+	char buf[2u * DEPTH + 16u];
+
+	strcpy(buf, deep_url());
+	TEST_ASSERT(route_segment(buf, parts, &count) == -ENOMEM);
+	TEST_ASSERT(strcmp(buf, deep_url()) == 0);
+
+	count = DEPTH;
+	struct route_part all[DEPTH];
+	TEST_ASSERT(route_segment(buf, all, &count) > 0);
+	TEST_ASSERT(count == DEPTH);
+	TEST_ASSERT(all[DEPTH - 1u].len == 2u && strcmp(all[DEPTH - 1u].str, "42") == 0);
+}
+
+int main(void)
+{
+	deep_init();
+
+	test_deep_resolve();
+	test_segment_table_full();
+
+	return TEST_RESULT();
+}
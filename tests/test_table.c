@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2022 Lucas Dietrich <ld.adecy@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include <embedc-url/parser.h>
+#include <embedc-url/parser_internal.h>
+#include <embedc-url/table.h>
+
+#include "test.h"
+
+#define READERS 4u
+#define VERSIONS 4u
+#define PUBLISHES 2000u
+
+static void handler(void)
+{
+}
+
+static const struct route_descr root[] = {
+	LEAF("info", GET, handler, NULL, 0u),
+};
+
+/* Version and its state, released versions are published again */
+struct version
+{
+	struct route_table_version v;
+	atomic_bool released;
+};
+
+static struct version versions[VERSIONS];
+static struct route_table table;
+static struct route_table_reader readers[READERS];
+static atomic_bool stop;
+static atomic_uint sections;
+
+static void version_release(struct route_table_version *v)
+{
+	struct version *const ver = (struct version *)v;
+
+	atomic_store(&ver->released, true);
+}
+
+static void versions_init(void)
+{
+	for (size_t i = 0u; i < VERSIONS; i++) {
+		versions[i].v = (struct route_table_version)
+			ROUTE_TABLE_VERSION(root, ARRAY_SIZE(root), version_release);
+		atomic_init(&versions[i].released, true);
+	}
+}
+
+/* Number of read sections which saw a released version */
+static void *reader_run(void *arg)
+{
+	struct route_table_reader *const reader = arg;
+	struct route_parse_result results[2u];
+	uintptr_t errors = 0u;
+
+	while (!atomic_load(&stop)) {
+		const struct route_table_version *const v = route_table_read_lock(&table, reader);
+		const struct version *const ver = (const struct version *)v;
+		size_t count = ARRAY_SIZE(results);
+
+		if (atomic_load(&ver->released))
+			errors++;
+
+		if (route_tree_resolve_const(v->root, v->size, "/info", 5u, GET, METHODS_MASK,
+					     results, &count, NULL) != &v->root[0u])
+			errors++;
+
+		/* Be preempted in the read section */
+		sched_yield();
+
+		if (atomic_load(&ver->released))
+			errors++;
+
+		route_table_read_unlock(reader);
+		atomic_fetch_add(&sections, 1u);
+
+		/* Let the writer run outside of read sections on few CPUs */
+		sched_yield();
+	}
+
+	return (void *)errors;
+}
+
+/* Publish released versions in turn, up to PUBLISHES times, while readers
+ * are running
+ */
+static void writer_run(void)
+{
+	size_t published = 0u;
+	size_t i = 0u;
+
+	while (published < PUBLISHES) {
+		i = (i + 1u) % VERSIONS;
+
+		/* Wait for readers to use the current version */
+		if (atomic_load(&sections) < published ||
+		    !atomic_load(&versions[i].released)) {
+			route_table_reclaim(&table);
+			sched_yield();
+			continue;
+		}
+
+		atomic_store(&versions[i].released, false);
+		TEST_ASSERT(route_table_publish(&table, &versions[i].v) >= 0);
+		published++;
+	}
+}
+
+/* Readers must never see a version released while in a read section */
+static void test_table_stress(unsigned int epoch)
+{
+	pthread_t threads[READERS];
+
+	versions_init();
+	atomic_store(&versions[0u].released, false);
+	TEST_ASSERT(route_table_init(&table, readers, READERS, &versions[0u].v) == 0);
+
+	/* Start close to the wraparound of the epoch */
+	atomic_store(&table.epoch, epoch);
+	atomic_store(&stop, false);
+	atomic_store(&sections, 0u);
+
+	for (size_t i = 0u; i < READERS; i++)
+		TEST_ASSERT(pthread_create(&threads[i], NULL, reader_run, &readers[i]) == 0);
+
+	writer_run();
+	atomic_store(&stop, true);
+
+	for (size_t i = 0u; i < READERS; i++) {
+		void *errors = NULL;
+
+		TEST_ASSERT(pthread_join(threads[i], &errors) == 0);
+		TEST_ASSERT(errors == NULL);
+	}
+
+	/* No reader left, only the current version is kept */
+	TEST_ASSERT(route_table_reclaim(&table) == 0);
+}
+
+/* Versions retired before a wraparound are still held by older readers */
+static void test_table_wraparound(void)
+{
+	struct route_table_reader reader = {0};
+
+	versions_init();
+	atomic_store(&versions[0u].released, false);
+	TEST_ASSERT(route_table_init(&table, &reader, 1u, &versions[0u].v) == 0);
+	atomic_store(&table.epoch, UINT32_MAX);
+
+	TEST_ASSERT(route_table_read_lock(&table, &reader) == &versions[0u].v);
+
+	atomic_store(&versions[1u].released, false);
+	TEST_ASSERT(route_table_publish(&table, &versions[1u].v) == 1);
+	TEST_ASSERT(atomic_load(&table.epoch) != ROUTE_TABLE_EPOCH_IDLE);
+
+	atomic_store(&versions[2u].released, false);
+	TEST_ASSERT(route_table_publish(&table, &versions[2u].v) == 2);
+	TEST_ASSERT(!atomic_load(&versions[0u].released));
+
+	route_table_read_unlock(&reader);
+	TEST_ASSERT(route_table_reclaim(&table) == 0);
+	TEST_ASSERT(atomic_load(&versions[0u].released));
+	TEST_ASSERT(atomic_load(&versions[1u].released));
+	TEST_ASSERT(!atomic_load(&versions[2u].released));
+}
+
+int main(void)
+{
+	test_table_wraparound();
+	test_table_stress(1u);
+	test_table_stress(UINT32_MAX - PUBLISHES / 2u);
+
+	return TEST_RESULT();
+}